@@ -0,0 +1,62 @@
+#include "alias_table.h"
+#include <algorithm>
+
+using namespace mesh3d;
+
+namespace mesh3d {
+
+namespace {
+
+struct alias_order {
+	const std::vector<index> &verts;
+	const std::vector<dom_vertex> &aliases;
+	alias_order(const std::vector<index> &verts, const std::vector<dom_vertex> &aliases)
+		: verts(verts), aliases(aliases) { }
+	bool operator()(index a, index b) const {
+		if (verts[a] != verts[b])
+			return verts[a] < verts[b];
+		return aliases[a].domain_id < aliases[b].domain_id;
+	}
+};
+
+}
+
+}
+
+index alias_list::find(index domain_id) const {
+	const_iterator it = std::lower_bound(_begin, _end, dom_vertex(domain_id, 0), dom_vertex::less);
+	if (it == _end || it->domain_id != domain_id)
+		return BAD_INDEX;
+	return it->remote_idx;
+}
+
+void alias_table::assign(const std::vector<index> &verts, const std::vector<dom_vertex> &aliases) {
+	std::vector<index> perm(verts.size());
+	for (index k = 0; k < perm.size(); k++)
+		perm[k] = k;
+	std::stable_sort(perm.begin(), perm.end(), alias_order(verts, aliases));
+
+	_verts.clear();
+	_ptr.assign(1, 0);
+	_aliases.clear();
+	for (index k = 0; k < perm.size(); k++) {
+		const index v = verts[perm[k]];
+		const dom_vertex &a = aliases[perm[k]];
+		if (_verts.empty() || _verts.back() != v) {
+			_verts.push_back(v);
+			_ptr.push_back(_ptr.back());
+		} else if (_aliases.back().domain_id == a.domain_id) {
+			_aliases.back() = a;
+			continue;
+		}
+		_aliases.push_back(a);
+		_ptr.back()++;
+	}
+}
+
+alias_list alias_table::aliases(index v) const {
+	std::vector<index>::const_iterator it = std::lower_bound(_verts.begin(), _verts.end(), v);
+	if (it == _verts.end() || *it != v)
+		return alias_list(0, 0);
+	return row(it - _verts.begin());
+}
@@ -0,0 +1,71 @@
+#ifndef __MESH3D__ALIAS_TABLE_H__
+#define __MESH3D__ALIAS_TABLE_H__
+
+#include "common.h"
+#include "vertex.h"
+
+#include <vector>
+
+namespace mesh3d {
+
+/** Aliases of a single vertex in other domains, sorted by domain id */
+class alias_list {
+	const dom_vertex *_begin;
+	const dom_vertex *_end;
+public:
+	typedef const dom_vertex *const_iterator;
+
+	/** Construct list from a range of aliases */
+	alias_list(const dom_vertex *b, const dom_vertex *e) : _begin(b), _end(e) { }
+	/** Return iterator to the first alias */
+	const_iterator begin() const { return _begin; }
+	/** Return iterator past the last alias */
+	const_iterator end() const { return _end; }
+	/** Return number of aliases */
+	index size() const { return _end - _begin; }
+	/** Check if vertex has no aliases */
+	bool empty() const { return _begin == _end; }
+	/** Return index of vertex in domain, or BAD_INDEX if it has no alias there */
+	index find(index domain_id) const;
+};
+
+/** Sorted CSR table of interface vertex aliases in other domains
+*
+* Only vertices having aliases are stored, so interior vertices cost nothing */
+class alias_table {
+	std::vector<index> _verts;
+	std::vector<index> _ptr;
+	std::vector<dom_vertex> _aliases;
+public:
+	/** Construct empty table */
+	alias_table() : _ptr(1, 0) { }
+	/** Exchange contents with other table */
+	void swap(alias_table &other) {
+		_verts.swap(other._verts);
+		_ptr.swap(other._ptr);
+		_aliases.swap(other._aliases);
+	}
+
+	/** Fill table from unordered list, aliases[k] belongs to vertex verts[k].
+	*
+	* Repeated aliases of a vertex in the same domain are merged, the last one wins */
+	void assign(const std::vector<index> &verts, const std::vector<dom_vertex> &aliases);
+
+	/** Return number of interface vertices */
+	index size() const { return _verts.size(); }
+	/** Return total number of aliases */
+	index nnz() const { return _aliases.size(); }
+	/** Return sorted indices of interface vertices */
+	const std::vector<index> &vertices() const { return _verts; }
+	/** Return aliases of k-th interface vertex */
+	alias_list row(index k) const {
+		const dom_vertex *p = _aliases.empty() ? 0 : &_aliases[0];
+		return alias_list(p + _ptr[k], p + _ptr[k + 1]);
+	}
+	/** Return aliases of vertex v, empty list for non-interface vertices */
+	alias_list aliases(index v) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,82 @@
+#include "instrument.h"
+#include <new>
+#include <cstdlib>
+
+/*
+	Replacement of global operator new and delete counting allocations for instrument_allocs.
+	It is built as the separate mesh3d_alloc_hooks library, so only applications that link
+	it explicitly get their allocation functions replaced. Array forms and sized deletes
+	forward to these by default.
+*/
+
+#if __cplusplus >= 201103L
+# define MESH3D_NOEXCEPT noexcept
+# define MESH3D_THROWS_BAD_ALLOC
+#else
+# define MESH3D_NOEXCEPT throw()
+# define MESH3D_THROWS_BAD_ALLOC throw(std::bad_alloc)
+#endif
+
+namespace {
+
+/* Allocations are prefixed with their size, the header keeps the default alignment */
+const size_t HEADER = 16;
+
+void *counted_alloc(size_t n) {
+	void *p = malloc(n + HEADER);
+	if (!p)
+		return 0;
+	*static_cast<size_t *>(p) = n;
+	mesh3d::instrument_record_alloc(n);
+	return static_cast<char *>(p) + HEADER;
+}
+
+void counted_free(void *p) {
+	if (!p)
+		return;
+	void *q = static_cast<char *>(p) - HEADER;
+	mesh3d::instrument_record_free(*static_cast<size_t *>(q));
+	free(q);
+}
+
+std::new_handler current_new_handler() {
+#if __cplusplus >= 201103L
+	return std::get_new_handler();
+#else
+	std::new_handler h = std::set_new_handler(0);
+	std::set_new_handler(h);
+	return h;
+#endif
+}
+
+}
+
+void *operator new(size_t n) MESH3D_THROWS_BAD_ALLOC {
+	if (n == 0)
+		n = 1;
+	for (;;) {
+		void *p = counted_alloc(n);
+		if (p)
+			return p;
+		std::new_handler h = current_new_handler();
+		if (!h)
+			throw std::bad_alloc();
+		h();
+	}
+}
+
+void *operator new(size_t n, const std::nothrow_t &) MESH3D_NOEXCEPT {
+	try {
+		return ::operator new(n);
+	} catch (std::bad_alloc &) {
+		return 0;
+	}
+}
+
+void operator delete(void *p) MESH3D_NOEXCEPT {
+	counted_free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) MESH3D_NOEXCEPT {
+	counted_free(p);
+}
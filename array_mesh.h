@@ -0,0 +1,62 @@
+#ifndef __MESH3D__ARRAY_MESH_H__
+#define __MESH3D__ARRAY_MESH_H__
+
+#include "simple_mesh.h"
+
+namespace mesh3d {
+
+/** simple_mesh view of caller-owned arrays, nothing is copied
+*
+* Arrays are laid out as in vector_mesh: 3 coordinates per vertex, 4 vertices per
+* tetrahedron and 3 per boundary face, one material per element. Indices are of mesh3d::index
+* type and zero based. The arrays should outlive the view. mesh construction reads them
+* directly, without per-element virtual calls */
+class array_mesh : public simple_mesh {
+	index nV;
+	index nT;
+	index nB;
+	const double *vert;
+	const index *tet;
+	const index *tetmat;
+	const index *bnd;
+	const index *bndmat;
+public:
+	/** Wrap nV vertices, nT tetrahedrons and nB boundary faces */
+	array_mesh(index nV, const double *vert,
+			index nT, const index *tet, const index *tetmat,
+			index nB, const index *bnd, const index *bndmat)
+		: nV(nV), nT(nT), nB(nB), vert(vert), tet(tet), tetmat(tetmat), bnd(bnd), bndmat(bndmat)
+	{ }
+
+	/** Return number of vertices in mesh */
+	virtual index num_vertices() const { return nV; }
+	/** Return number of tetrahedrons in mesh */
+	virtual index num_tetrahedrons() const { return nT; }
+	/** Return number of boundary faces in mesh */
+	virtual index num_bnd_faces() const { return nB; }
+	/** Return i-th vertex coordinates as an array of 3 doubles */
+	virtual const double *vertex_coord(index i) const { return vert + 3 * i; }
+	/** Return i-th tetrahedron vertices as an array of 4 indices. Order matters */
+	virtual const index *tet_verts(index i) const { return tet + 4 * i; }
+	/** Return i-th boundary face vertices as an array of 3 indices. Order matters */
+	virtual const index *bnd_verts(index i) const { return bnd + 3 * i; }
+	/** Return i-th tetrahedron material (color) */
+	virtual index tet_material(index i) const { return tetmat[i]; }
+	/** Return i-th boundary face material (color) */
+	virtual index bnd_material(index i) const { return bndmat[i]; }
+
+	/** Return vertex coordinates array */
+	const double *vertex_array() const { return vert; }
+	/** Return tetrahedron vertices array */
+	const index *tet_array() const { return tet; }
+	/** Return tetrahedron materials array */
+	const index *tet_material_array() const { return tetmat; }
+	/** Return boundary face vertices array */
+	const index *bnd_array() const { return bnd; }
+	/** Return boundary face materials array */
+	const index *bnd_material_array() const { return bndmat; }
+};
+
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef __MESH3D__BENCH_H__
+#define __MESH3D__BENCH_H__
+
+#include <time.h>
+#include <sys/resource.h>
+
+namespace mesh3d {
+
+/** Return monotonic wall clock time in seconds */
+inline double wtime() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+/** Return peak resident set size of the process in kilobytes */
+inline long peak_rss_kb() {
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	return ru.ru_maxrss;
+}
+
+}
+
+#endif
@@ -0,0 +1,139 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "mesh_adjacency.h"
+#include "refine.h"
+#include "bench.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+using namespace mesh3d;
+
+/* Compare neighbour traversal through CSR adjacency tables against pointer hops.
+   Usage: bench_adjacency [mesh.vol [refinements [repetitions]]] */
+int main(int argc, char **argv) {
+	const char *fn = argc > 1 ? argv[1] : "mesh.vol";
+	int levels = argc > 2 ? atoi(argv[2]) : 2;
+	int reps = argc > 3 ? atoi(argv[3]) : 20;
+
+	try {
+		vol_mesh vm(fn);
+		vector_mesh fine(vm);
+		for (int l = 0; l < levels; l++) {
+			mesh coarse(fine, 0, 1, false);
+			vector_mesh next;
+			refine_uniform(coarse, next);
+			std::swap(fine.vert, next.vert);
+			std::swap(fine.tet, next.tet);
+			std::swap(fine.bnd, next.bnd);
+			std::swap(fine.tetmat, next.tetmat);
+			std::swap(fine.bndmat, next.bndmat);
+		}
+		mesh m(fine, 0, 1, false);
+		const index nV = m.vertices().size();
+		const index nT = m.tets().size();
+
+		double t = wtime();
+		mesh_adjacency adj(m);
+		std::cout << "vertices = " << nV << ", tets = " << nT << ", build: " << 1e9 * (wtime() - t) / nT << " ns/tet" << std::endl;
+
+		std::vector<double> u(nV), v(nV), a(nT), b(nT);
+		for (index i = 0; i < nV; i++)
+			u[i] = std::sin(double(i));
+		for (index i = 0; i < nT; i++)
+			a[i] = std::cos(double(i));
+		double check = 0;
+
+		/* Finite volume flux sum over tetrahedron faces */
+		t = wtime();
+		for (int k = 0; k < reps; k++)
+			for (index i = 0; i < nT; i++) {
+				const tetrahedron &tet = m.tets(i);
+				double s = 0;
+				for (int j = 0; j < 4; j++) {
+					const face &g = tet.f(j).flip();
+					if (!g.is_border())
+						s += a[g.tet().idx()] - a[i];
+				}
+				b[i] = s;
+			}
+		double tp = wtime() - t;
+		check += b[nT / 2];
+		t = wtime();
+		for (int k = 0; k < reps; k++)
+			for (index i = 0; i < nT; i++) {
+				const index *n = adj.tet_tets(i);
+				double s = 0;
+				for (int j = 0; j < 4; j++)
+					if (n[j] != BAD_INDEX)
+						s += a[n[j]] - a[i];
+				b[i] = s;
+			}
+		double tc = wtime() - t;
+		check -= b[nT / 2];
+		std::cout << "tet -> tet: pointer " << 1e9 * tp / reps / nT << " ns/tet, csr "
+			<< 1e9 * tc / reps / nT << " ns/tet" << std::endl;
+
+		/* Gather of cell values to vertices */
+		const csr &vt = adj.vertex_tets();
+		t = wtime();
+		for (int k = 0; k < reps; k++)
+			for (index i = 0; i < nV; i++) {
+				const std::vector<tet_vertex> &tl = m.vertices(i).tetrahedrons();
+				double s = 0;
+				for (std::vector<tet_vertex>::const_iterator it = tl.begin(); it != tl.end(); ++it)
+					s += a[it->t->idx()];
+				v[i] = s;
+			}
+		tp = wtime() - t;
+		check += v[nV / 2];
+		t = wtime();
+		for (int k = 0; k < reps; k++)
+			for (index i = 0; i < nV; i++) {
+				const index *r = vt.row(i);
+				double s = 0;
+				for (index j = 0; j < vt.size(i); j++)
+					s += a[r[j]];
+				v[i] = s;
+			}
+		tc = wtime() - t;
+		check -= v[nV / 2];
+		std::cout << "vertex -> tet: pointer " << 1e9 * tp / reps / vt.nnz() << " ns/entry, csr "
+			<< 1e9 * tc / reps / vt.nnz() << " ns/entry" << std::endl;
+
+		/* Graph Laplacian over vertex neighbours. The pointer path visits every neighbour
+		   once per shared tetrahedron */
+		const csr &vv = adj.vertex_vertices();
+		t = wtime();
+		for (int k = 0; k < reps; k++)
+			for (index i = 0; i < nV; i++) {
+				const std::vector<tet_vertex> &tl = m.vertices(i).tetrahedrons();
+				double s = 0;
+				for (std::vector<tet_vertex>::const_iterator it = tl.begin(); it != tl.end(); ++it)
+					for (int j = 0; j < 4; j++)
+						if (j != it->li)
+							s += u[it->t->p(j).idx()] - u[i];
+				v[i] = s;
+			}
+		tp = wtime() - t;
+		t = wtime();
+		for (int k = 0; k < reps; k++)
+			for (index i = 0; i < nV; i++) {
+				const index *r = vv.row(i);
+				double s = 0;
+				for (index j = 0; j < vv.size(i); j++)
+					s += u[r[j]] - u[i];
+				v[i] = s;
+			}
+		tc = wtime() - t;
+		std::cout << "vertex -> vertex: pointer " << 1e9 * tp / reps / nV << " ns/vertex, csr "
+			<< 1e9 * tc / reps / nV << " ns/vertex" << std::endl;
+
+		if (std::fabs(check) > 1e-10)
+			std::cerr << "Traversal results differ" << std::endl;
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
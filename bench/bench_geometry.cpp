@@ -0,0 +1,86 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "geometry.h"
+#include "bench.h"
+#include <iostream>
+#include <cstdlib>
+
+using namespace mesh3d;
+
+/* Compare per-object geometry computation with batch kernels.
+   Usage: bench_geometry [mesh.vol [repetitions]] */
+int main(int argc, char **argv) {
+	const char *fn = argc > 1 ? argv[1] : "mesh.vol";
+	int reps = argc > 2 ? atoi(argv[2]) : 200;
+
+	try {
+		vol_mesh vm(fn);
+		mesh m(vm);
+
+		index nV = m.vertices().size();
+		index nF = m.faces().size();
+		index nT = m.tets().size();
+
+		std::vector<double> x(nV), y(nV), z(nV);
+		for (index i = 0; i < nV; i++) {
+			x[i] = m.vertices(i).r().x;
+			y[i] = m.vertices(i).r().y;
+			z[i] = m.vertices(i).r().z;
+		}
+		soa_coords r;
+		r.x = &x[0];
+		r.y = &y[0];
+		r.z = &z[0];
+
+		std::vector<index> fv(3 * nF), tv(4 * nT);
+		for (index i = 0; i < nF; i++)
+			for (int j = 0; j < 3; j++)
+				fv[3 * i + j] = m.faces(i).p(j).idx();
+		for (index i = 0; i < nT; i++)
+			for (int j = 0; j < 4; j++)
+				tv[4 * i + j] = m.tets(i).p(j).idx();
+
+		std::vector<double> fbuf(7 * nF), tbuf(4 * nT);
+		face_geometry fg;
+		fg.nx = &fbuf[0 * nF];
+		fg.ny = &fbuf[1 * nF];
+		fg.nz = &fbuf[2 * nF];
+		fg.cx = &fbuf[3 * nF];
+		fg.cy = &fbuf[4 * nF];
+		fg.cz = &fbuf[5 * nF];
+		fg.surface = &fbuf[6 * nF];
+		tet_geometry tg;
+		tg.cx = &tbuf[0 * nT];
+		tg.cy = &tbuf[1 * nT];
+		tg.cz = &tbuf[2 * nT];
+		tg.volume = &tbuf[3 * nT];
+
+		std::cout << "faces = " << nF << ", tets = " << nT << ", repetitions = " << reps << std::endl;
+
+		double t = wtime();
+		for (int k = 0; k < reps; k++) {
+			for (index i = 0; i < nF; i++)
+				const_cast<face &>(m.faces(i)).update_geometry();
+			for (index i = 0; i < nT; i++)
+				const_cast<tetrahedron &>(m.tets(i)).update_geometry();
+		}
+		double base = wtime() - t;
+		std::cout << "per-object: " << 1e9 * base / reps / (nF + nT) << " ns/element" << std::endl;
+
+		const char *names[] = {"scalar", "avx2", "avx512"};
+		for (int level = SIMD_SCALAR; level <= best_simd_level(); level++) {
+			t = wtime();
+			for (int k = 0; k < reps; k++) {
+				compute_face_geometry(nF, r, &fv[0], fg, static_cast<simd_level>(level));
+				compute_tet_geometry(nT, r, &tv[0], tg, static_cast<simd_level>(level));
+			}
+			double dt = wtime() - t;
+			std::cout << "kernel " << names[level] << ": " << 1e9 * dt / reps / (nF + nT) << " ns/element, "
+				<< "speedup " << base / dt << std::endl;
+		}
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,163 @@
+#include "cube_mesh.h"
+#include "array_mesh.h"
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "vtk_stream.h"
+#include "parallel.h"
+#include "instrument.h"
+#include "bench.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+
+using namespace mesh3d;
+
+/** Print one result as a JSON object on a single line */
+void report(const char *name, index n, index nT, double seconds, size_t bytes = 0) {
+	std::cout << "{\"bench\": \"" << name << "\", \"cells\": " << n << ", \"tets\": " << nT
+		<< ", \"threads\": " << num_threads()
+		<< ", \"seconds\": " << seconds
+		<< ", \"tets_per_second\": " << (seconds > 0 ? nT / seconds : 0);
+	if (bytes)
+		std::cout << ", \"bytes\": " << bytes
+			<< ", \"mb_per_second\": " << (seconds > 0 ? 1e-6 * bytes / seconds : 0);
+	std::cout << ", \"peak_rss_kb\": " << peak_rss_kb() << "}" << std::endl;
+}
+
+/** Write mesh in NETGEN vol format, all boundary faces facing the outer domain */
+size_t write_vol(const simple_mesh &sm, const char *fn) {
+	std::ofstream f(fn);
+	f << "mesh3d\ndimension\n3\ngeomtype\n0\n\n";
+	f << "# surfnr    bcnr   domin  domout      np      p1      p2      p3\n";
+	f << "surfaceelements\n" << sm.num_bnd_faces() << "\n";
+	for (index i = 0; i < sm.num_bnd_faces(); i++) {
+		const index *v = sm.bnd_verts(i);
+		f << sm.bnd_material(i) << " " << sm.bnd_material(i) << " 1 0 3 "
+			<< v[0] + 1 << " " << v[1] + 1 << " " << v[2] + 1 << "\n";
+	}
+	f << "\n#  matnr      np      p1      p2      p3      p4\n";
+	f << "volumeelements\n" << sm.num_tetrahedrons() << "\n";
+	for (index i = 0; i < sm.num_tetrahedrons(); i++) {
+		const index *v = sm.tet_verts(i);
+		f << sm.tet_material(i) << " 4 "
+			<< v[0] + 1 << " " << v[1] + 1 << " " << v[2] + 1 << " " << v[3] + 1 << "\n";
+	}
+	f << "\npoints\n" << sm.num_vertices() << "\n";
+	f.precision(17);
+	for (index i = 0; i < sm.num_vertices(); i++) {
+		const double *r = sm.vertex_coord(i);
+		f << r[0] << " " << r[1] << " " << r[2] << "\n";
+	}
+	f << "endmesh\n";
+	return f.tellp();
+}
+
+void run(index n, const char *tmp_vol, const char *tmp_vtk) {
+	double t = wtime();
+	cube_mesh cm(n);
+	const index nT = cm.num_tetrahedrons();
+	report("cube_generate", n, nT, wtime() - t);
+
+	size_t bytes = write_vol(cm, tmp_vol);
+	t = wtime();
+	{
+		vol_mesh vm(tmp_vol);
+		report("vol_parse", n, nT, wtime() - t, bytes);
+	}
+	std::remove(tmp_vol);
+
+	/* Element construction, vertex lists and face flip matching */
+	t = wtime();
+	mesh m(cm, 0, 1, false);
+	report("mesh_topology", n, nT, wtime() - t);
+
+	/* The same through array_mesh, read without virtual calls */
+	{
+		array_mesh am(cm.num_vertices(), &cm.vert[0], nT, &cm.tet[0], &cm.tetmat[0],
+			cm.num_bnd_faces(), &cm.bnd[0], &cm.bndmat[0]);
+		t = wtime();
+		mesh ma(am, 0, 1, false);
+		report("mesh_topology_array", n, nT, wtime() - t);
+	}
+
+	t = wtime();
+	m.update_geometry();
+	report("mesh_geometry", n, nT, wtime() - t);
+
+	t = wtime();
+	bool ok = m.check();
+	report("check", n, nT, wtime() - t);
+	if (!ok)
+		throw std::logic_error("Generated mesh failed check");
+
+	std::stringstream ss;
+	t = wtime();
+	m.serialize(ss);
+	bytes = ss.str().size();
+	report("serialize", n, nT, wtime() - t, bytes);
+
+	t = wtime();
+	{
+		mesh copy(ss);
+		report("deserialize", n, nT, wtime() - t, bytes);
+	}
+
+#ifdef USE_METIS
+	const index parts = 4;
+	t = wtime();
+	tet_graph tg(m);
+	report("tet_graph", n, nT, wtime() - t);
+
+	t = wtime();
+	tg.partition(parts);
+	report("partition", n, nT, wtime() - t);
+
+	t = wtime();
+	for (index d = 0; d < parts; d++)
+		mesh part(m, d, tg);
+	report("extract_parts", n, nT, wtime() - t);
+#endif
+
+	std::vector<double> vol(nT);
+	for (index i = 0; i < nT; i++)
+		vol[i] = m.tets(i).volume();
+	t = wtime();
+	{
+		vtk_stream vtk(tmp_vtk);
+		vtk.write_header(m, "bench");
+		vtk.append_cell_data(&vol[0], "volume");
+		vtk.close();
+	}
+	report("vtk_write", n, nT, wtime() - t);
+	std::remove(tmp_vtk);
+}
+
+/* Run the pipeline stages on structured cube meshes, one JSON object per result.
+   If built with MESH3D_INSTRUMENT, library region statistics are printed last.
+   Usage: bench_suite [cells per side...] */
+int main(int argc, char **argv) {
+	std::vector<index> sizes;
+	for (int i = 1; i < argc; i++)
+		sizes.push_back(atoi(argv[i]));
+	if (sizes.empty()) {
+		sizes.push_back(8);
+		sizes.push_back(16);
+		sizes.push_back(32);
+	}
+
+	try {
+		for (size_t i = 0; i < sizes.size(); i++)
+			run(sizes[i], "bench_suite.vol", "bench_suite.vtk");
+		if (instrument_enabled()) {
+			instrument_dump(std::cout);
+			std::cout << std::endl;
+		}
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
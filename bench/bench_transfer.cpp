@@ -0,0 +1,66 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "mesh_transfer.h"
+#include "bench.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+using namespace mesh3d;
+
+/* Measure field transfer throughput between a mesh and its copy with shaken interior vertices.
+   Usage: bench_transfer [mesh.vol [repetitions]] */
+int main(int argc, char **argv) {
+	const char *fn = argc > 1 ? argv[1] : "mesh.vol";
+	int reps = argc > 2 ? atoi(argv[2]) : 100;
+
+	try {
+		vol_mesh vm(fn);
+		mesh src(vm);
+		mesh dst(vm);
+
+		double hmin = -1;
+		for (index i = 0; i < src.tets().size(); i++) {
+			double h = std::pow(src.tets(i).volume(), 1. / 3);
+			if (hmin < 0 || h < hmin)
+				hmin = h;
+		}
+		std::vector<bool> border(src.vertices().size(), false);
+		for (index i = 4 * src.tets().size(); i < src.faces().size(); i++)
+			for (int j = 0; j < 3; j++)
+				border[src.faces(i).p(j).idx()] = true;
+		std::vector<index> verts;
+		std::vector<vector> r;
+		for (index i = 0; i < src.vertices().size(); i++)
+			if (!border[i]) {
+				verts.push_back(i);
+				r.push_back(src.vertices(i).r() + 0.1 * hmin * vector(std::sin(i), std::cos(3. * i), std::sin(5. * i)));
+			}
+		dst.move_vertices(verts.size(), &verts[0], &r[0]);
+
+		const index nV = dst.vertices().size();
+		const index nT = dst.tets().size();
+		std::cout << "vertices = " << nV << ", tets = " << nT << ", repetitions = " << reps << std::endl;
+
+		const char *names[] = {"nearest", "conservative"};
+		for (int mode = CELL_NEAREST; mode <= CELL_CONSERVATIVE; mode++) {
+			double t = wtime();
+			mesh_transfer tr(src, dst, static_cast<cell_transfer_mode>(mode));
+			double setup = wtime() - t;
+			std::cout << names[mode] << " setup: " << 1e6 * setup / nT << " us/tet" << std::endl;
+
+			std::vector<double> u(nV, 1), v(nV), a(nT, 1), b(nT);
+			t = wtime();
+			for (int k = 0; k < reps; k++) {
+				tr.vertex_data(&u[0], &v[0]);
+				tr.cell_data(&a[0], &b[0]);
+			}
+			double apply = wtime() - t;
+			std::cout << names[mode] << " transfer: " << 1e9 * apply / reps / (nV + nT) << " ns/element" << std::endl;
+		}
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,59 @@
+#include "check_report.h"
+#include <sstream>
+
+using namespace mesh3d;
+
+std::string check_error::message() const {
+	std::ostringstream ss;
+	switch (kind) {
+		case DOMAIN_NUMBER:
+			ss << "Domain number " << element << " is not less than domain count " << other;
+			break;
+		case FACE_INDEX:
+			ss << "Face #" << element << " has wrong index";
+			break;
+		case FACE_FLIP:
+			ss << "Face #" << element << " twice flipped is not the same";
+			break;
+		case FACE_FLIP_ORIENT:
+			ss << "Face #" << element << " flip not opposed to face (probably wrong oriented face)";
+			break;
+		case FACE_SURFACE:
+			ss << "Face #" << element << " has negative surface = " << value;
+			break;
+		case TET_INDEX:
+			ss << "Tet #" << element << " has wrong index";
+			break;
+		case TET_VOLUME:
+			ss << "Tet #" << element << " has negative volume = " << value;
+			break;
+		case TET_FACE_NORMAL:
+			ss << "Tet #" << element << " has " << local << "-th face improperly oriented";
+			break;
+		case VERTEX_INDEX:
+			ss << "Vertex #" << element << " has wrong index";
+			break;
+		case VERTEX_TET_LIST:
+			ss << "Tet #" << other << " has " << local << "-th vertex incorrectly listed in vertex #"
+				<< element << " _tets list";
+			break;
+		case VERTEX_FACE_LIST:
+			ss << "Face #" << other << " has " << local << "-th vertex incorrectly listed in vertex #"
+				<< element << " _faces list";
+			break;
+		case TET_LIST_SIZE:
+			ss << "Total elems list has wrong size " << element << " != " << other;
+			break;
+		case FACE_LIST_SIZE:
+			ss << "Total _faces list has wrong size " << element << " != " << other;
+			break;
+	}
+	return ss.str();
+}
+
+void check_report::print(std::ostream &o) const {
+	for (std::vector<check_error>::const_iterator it = errors.begin(); it != errors.end(); ++it)
+		o << it->message() << std::endl;
+	if (truncated())
+		o << (total - errors.size()) << " more problems not shown" << std::endl;
+}
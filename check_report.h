@@ -0,0 +1,76 @@
+#ifndef __MESH3D__CHECK_REPORT_H__
+#define __MESH3D__CHECK_REPORT_H__
+
+#include "common.h"
+
+#include <vector>
+#include <string>
+#include <ostream>
+
+namespace mesh3d {
+
+/** Set of checks performed by mesh::validate */
+enum check_level {
+	CHECK_TOPOLOGY, //!< Element indices, flipped faces and vertex lists only
+	CHECK_FULL //!< Topology and geometry checks. Geometry is skipped if mesh has no geometry
+};
+
+/** A single problem found by mesh::validate */
+struct check_error {
+	/** Kind of the problem. Per-element kinds are grouped by the sweep finding them */
+	enum kind_t {
+		DOMAIN_NUMBER, //!< element is domain number, other is domain count
+
+		FACE_INDEX, //!< element is face with wrong index
+		FACE_FLIP, //!< element is face which twice flipped is not the same
+		FACE_FLIP_ORIENT, //!< element is face not opposed to its flip
+		FACE_SURFACE, //!< element is face with nonpositive surface value
+
+		TET_INDEX, //!< element is tet with wrong index
+		TET_VOLUME, //!< element is tet with nonpositive volume value
+		TET_FACE_NORMAL, //!< element is tet with local-th face improperly oriented
+
+		VERTEX_INDEX, //!< element is vertex with wrong index
+		VERTEX_TET_LIST, //!< element is vertex, other is tet with local-th vertex incorrectly listed
+		VERTEX_FACE_LIST, //!< element is vertex, other is face with local-th vertex incorrectly listed
+
+		TET_LIST_SIZE, //!< element is total size of vertex tet lists, other is expected one
+		FACE_LIST_SIZE //!< element is total size of vertex face lists, other is expected one
+	};
+
+	kind_t kind; //!< Kind of the problem
+	index element; //!< Offending element
+	index other; //!< Related element or BAD_INDEX
+	int local; //!< Related local index or -1
+	double value; //!< Offending value or zero
+
+	/** Construct error of specified kind */
+	check_error(kind_t kind, index element, index other = BAD_INDEX, int local = -1, double value = 0)
+		: kind(kind), element(element), other(other), local(local), value(value)
+	{ }
+
+	/** Return human readable description of the problem */
+	std::string message() const;
+};
+
+/** Result of mesh::validate */
+struct check_report {
+	/** Found problems ordered by element. At most max_errors per-element problems are stored,
+	* domain and list size problems are always stored */
+	std::vector<check_error> errors;
+	/** Total number of problems found, including not stored ones */
+	index total;
+
+	/** Construct empty report */
+	check_report() : total(0) { }
+	/** Check if no problems were found */
+	bool ok() const { return total == 0; }
+	/** Check if some problems were found but not stored */
+	bool truncated() const { return total > errors.size(); }
+	/** Write every stored problem on a separate line */
+	void print(std::ostream &o) const;
+};
+
+}
+
+#endif
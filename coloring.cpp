@@ -0,0 +1,79 @@
+#include "coloring.h"
+#include "mesh_adjacency.h"
+#include "flux_faces.h"
+
+using namespace mesh3d;
+
+namespace mesh3d {
+
+namespace {
+
+/** Return the least color not marked with stamp */
+index least_free(const std::vector<index> &mark, index stamp) {
+	index c = 0;
+	while (c < mark.size() && mark[c] == stamp)
+		c++;
+	return c;
+}
+
+void set_color(std::vector<index> &mark, std::vector<index> &colors, index i, index c, index &ncolors) {
+	colors[i] = c;
+	if (c >= ncolors) {
+		ncolors = c + 1;
+		mark.resize(ncolors, BAD_INDEX);
+	}
+}
+
+}
+
+}
+
+void mesh3d::color_tets(const mesh_adjacency &adj, csr &groups) {
+	const csr &vt = adj.vertex_tets();
+	const index nT = vt.nnz() / 4;
+
+	/* Vertices of every tetrahedron, recovered from the vertex to tetrahedron table */
+	std::vector<index> verts(4 * nT), fill(nT, 0);
+	for (index v = 0; v < vt.rows(); v++)
+		for (index k = 0; k < vt.size(v); k++) {
+			const index t = vt.row(v)[k];
+			verts[4 * t + fill[t]++] = v;
+		}
+
+	std::vector<index> colors(nT, BAD_INDEX), mark;
+	index ncolors = 0;
+	for (index t = 0; t < nT; t++) {
+		for (int j = 0; j < 4; j++) {
+			const index v = verts[4 * t + j];
+			for (index k = 0; k < vt.size(v); k++) {
+				const index c = colors[vt.row(v)[k]];
+				if (c != BAD_INDEX)
+					mark[c] = t;
+			}
+		}
+		set_color(mark, colors, t, least_free(mark, t), ncolors);
+	}
+	groups.transpose(colors.empty() ? 0 : &colors[0], nT, 1, ncolors);
+}
+
+void mesh3d::color_inner_faces(const flux_faces &ff, index nT, csr &groups) {
+	const std::vector<inner_face> &in = ff.inner();
+	const index nI = in.size();
+
+	/* Colors of already colored faces of every tetrahedron, at most four */
+	std::vector<index> tet_colors(4 * nT, BAD_INDEX);
+	std::vector<int> used(nT, 0);
+	std::vector<index> colors(nI, BAD_INDEX), mark;
+	index ncolors = 0;
+	for (index k = 0; k < nI; k++) {
+		const index lr[2] = {in[k].left, in[k].right};
+		for (int s = 0; s < 2; s++)
+			for (int j = 0; j < used[lr[s]]; j++)
+				mark[tet_colors[4 * lr[s] + j]] = k;
+		const index c = least_free(mark, k);
+		set_color(mark, colors, k, c, ncolors);
+		for (int s = 0; s < 2; s++)
+			tet_colors[4 * lr[s] + used[lr[s]]++] = c;
+	}
+	groups.transpose(colors.empty() ? 0 : &colors[0], nI, 1, ncolors);
+}
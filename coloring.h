@@ -0,0 +1,27 @@
+#ifndef __MESH3D__COLORING_H__
+#define __MESH3D__COLORING_H__
+
+#include "common.h"
+#include "csr.h"
+
+namespace mesh3d {
+
+class mesh_adjacency;
+class flux_faces;
+
+/** Greedy coloring of tetrahedrons, tetrahedrons of one color share no vertices
+*
+* Row k of groups lists tetrahedrons of color k in increasing order, so scatter to vertices
+* may run in parallel inside every row without atomics. Colors are assigned in tetrahedron
+* order, the result is deterministic */
+void color_tets(const mesh_adjacency &adj, csr &groups);
+
+/** Greedy coloring of inner faces, faces of one color share no tetrahedrons
+*
+* Row k of groups lists indices into ff.inner() of color k in increasing order, so flux
+* accumulation to tetrahedrons may run in parallel inside every row without atomics */
+void color_inner_faces(const flux_faces &ff, index nT, csr &groups);
+
+}
+
+#endif
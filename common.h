@@ -7,15 +7,32 @@
 #include <vector>
 #include <cstddef>
 #include <limits>
+#include <stdint.h>
 
 namespace mesh3d {
 
 /** Index used to enumerate mesh elements (vertices, faces, etc). 
 *
-* BAD_INDEX is used to indicate absent element */
+* BAD_INDEX is used to indicate absent element. Built with MESH3D_INDEX32 the index is
+* 32-bit, which halves connectivity arrays for meshes under 2^32 elements */
+#ifdef MESH3D_INDEX32
+typedef uint32_t index;
+#else
 typedef size_t index;
+#endif
+
+const index BAD_INDEX = std::numeric_limits<index>::max();
+
+/** Type used to store element colors. Built with MESH3D_COLOR16 colors are 16-bit
+*
+* Colors are passed around as index, BAD_COLOR is stored in place of BAD_INDEX */
+#ifdef MESH3D_COLOR16
+typedef uint16_t color_type;
+#else
+typedef index color_type;
+#endif
 
-const index BAD_INDEX = std::numeric_limits<size_t>::max();
+const color_type BAD_COLOR = std::numeric_limits<color_type>::max();
 
 /** Internal function to be wrapped in ASSERT macro. Is not stripped in release */
 void assert(bool condition, const std::string &message, const std::string &file, const int line);
@@ -34,6 +51,14 @@ public:
 	ptr_vector() { }
 	/** Construct ptr_vector of specified size and optional default pointer */
 	explicit ptr_vector(size_t n, T *p = 0) : _data(n, p) { }
+#if __cplusplus >= 201103L
+	/** Move construct ptr_vector, pointers are taken over from other */
+	ptr_vector(ptr_vector &&other) { _data.swap(other._data); }
+	/** Move assign ptr_vector, own pointers are deleted */
+	ptr_vector &operator =(ptr_vector &&other) { ptr_vector tmp(static_cast<ptr_vector &&>(other)); swap(tmp); return *this; }
+#endif
+	/** Exchange pointers with other ptr_vector */
+	void swap(ptr_vector &other) { _data.swap(other._data); }
 	/** Get reference to an element */
 	T &operator[](ptrdiff_t i) { return *_data[i]; }
 	/** Get const reference to an element */
@@ -0,0 +1,54 @@
+#ifndef __MESH3D__CSR_H__
+#define __MESH3D__CSR_H__
+
+#include "common.h"
+
+#include <vector>
+
+namespace mesh3d {
+
+/** Compressed sparse row table, a list of index lists stored in two flat arrays */
+class csr {
+	std::vector<index> _ptr;
+	std::vector<index> _idx;
+public:
+	/** Construct empty table */
+	csr() : _ptr(1, 0) { }
+
+	/** Return number of rows */
+	index rows() const { return _ptr.size() - 1; }
+	/** Return total number of entries */
+	index nnz() const { return _idx.size(); }
+	/** Return number of entries in i-th row */
+	index size(index i) const { return _ptr[i + 1] - _ptr[i]; }
+	/** Return pointer to the first entry of i-th row */
+	const index *row(index i) const { return _idx.empty() ? 0 : &_idx[0] + _ptr[i]; }
+	/** Return row offsets array of rows() + 1 elements */
+	const std::vector<index> &ptr() const { return _ptr; }
+	/** Return entries array */
+	const std::vector<index> &idx() const { return _idx; }
+	/** Return mutable row offsets, for building tables */
+	std::vector<index> &ptr() { return _ptr; }
+	/** Return mutable entries, for building tables */
+	std::vector<index> &idx() { return _idx; }
+
+	/** Build transposed table of n rows with arity entries each, stored as rows[arity * i + j].
+	*
+	* Row k of the result lists every i having k among its entries, in increasing order */
+	void transpose(const index *rows, index n, index arity, index columns) {
+		_ptr.assign(columns + 1, 0);
+		for (index i = 0; i < n * arity; i++)
+			_ptr[rows[i] + 1]++;
+		for (index k = 0; k < columns; k++)
+			_ptr[k + 1] += _ptr[k];
+		_idx.resize(n * arity);
+		std::vector<index> pos(_ptr.begin(), _ptr.end() - 1);
+		for (index i = 0; i < n; i++)
+			for (index j = 0; j < arity; j++)
+				_idx[pos[rows[arity * i + j]]++] = i;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,101 @@
+#include "cube_mesh.h"
+#include <stdexcept>
+#include <algorithm>
+
+using namespace mesh3d;
+
+namespace mesh3d {
+
+namespace {
+
+/** Axis permutations, every one gives a path along cell edges from corner (0, 0, 0) to (1, 1, 1) */
+const int axis_paths[6][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+
+/** Local vertices of tetrahedron faces, in the order used by mesh */
+const int tet_face_verts[4][3] = {{1, 2, 3}, {0, 3, 2}, {0, 1, 3}, {0, 2, 1}};
+
+}
+
+}
+
+cube_mesh::cube_mesh(index n, double size) {
+	if (n == 0)
+		throw std::invalid_argument("Cube mesh should have at least one cell");
+
+	const index m = n + 1;
+	const double h = size / n;
+
+	vert.resize(3 * m * m * m);
+	for (index k = 0; k < m; k++)
+		for (index j = 0; j < m; j++)
+			for (index i = 0; i < m; i++) {
+				double *r = &vert[3 * (i + m * (j + m * k))];
+				r[0] = h * i;
+				r[1] = h * j;
+				r[2] = h * k;
+			}
+
+	/* Offsets of tetrahedron vertices from the cell corner, oriented once for every path */
+	int offs[6][4][3];
+	for (int p = 0; p < 6; p++) {
+		int c[3] = {0, 0, 0};
+		for (int l = 0; l < 3; l++)
+			offs[p][0][l] = 0;
+		for (int s = 0; s < 3; s++) {
+			c[axis_paths[p][s]] = 1;
+			for (int l = 0; l < 3; l++)
+				offs[p][s + 1][l] = c[l];
+		}
+		/* Same orientation test as for vol meshes: (r3 - r4) . ((r1 - r4) x (r2 - r4)) > 0 */
+		int a[3], b[3], d[3];
+		for (int l = 0; l < 3; l++) {
+			a[l] = offs[p][0][l] - offs[p][3][l];
+			b[l] = offs[p][1][l] - offs[p][3][l];
+			d[l] = offs[p][2][l] - offs[p][3][l];
+		}
+		int vol = d[0] * (a[1] * b[2] - a[2] * b[1])
+			+ d[1] * (a[2] * b[0] - a[0] * b[2])
+			+ d[2] * (a[0] * b[1] - a[1] * b[0]);
+		if (vol < 0)
+			for (int l = 0; l < 3; l++)
+				std::swap(offs[p][0][l], offs[p][1][l]);
+	}
+
+	tet.resize(24 * n * n * n);
+	tetmat.assign(6 * n * n * n, 1);
+	bnd.reserve(36 * n * n);
+	bndmat.reserve(12 * n * n);
+
+	for (index k = 0; k < n; k++)
+		for (index j = 0; j < n; j++)
+			for (index i = 0; i < n; i++) {
+				const index c[3] = {i, j, k};
+				const bool outer = i == 0 || j == 0 || k == 0 || i == n - 1 || j == n - 1 || k == n - 1;
+				index *t = &tet[24 * (i + n * (j + n * k))];
+				for (int p = 0; p < 6; p++) {
+					index v[4][3];
+					for (int q = 0; q < 4; q++) {
+						for (int l = 0; l < 3; l++)
+							v[q][l] = c[l] + offs[p][q][l];
+						t[4 * p + q] = v[q][0] + m * (v[q][1] + m * v[q][2]);
+					}
+					if (!outer)
+						continue;
+					/* Boundary faces are flips of tetrahedron faces lying on cube sides */
+					for (int f = 0; f < 4; f++) {
+						const int *fv = tet_face_verts[f];
+						for (int l = 0; l < 3; l++) {
+							const index x = v[fv[0]][l];
+							if (x != 0 && x != n)
+								continue;
+							if (v[fv[1]][l] != x || v[fv[2]][l] != x)
+								continue;
+							bnd.push_back(t[4 * p + fv[0]]);
+							bnd.push_back(t[4 * p + fv[2]]);
+							bnd.push_back(t[4 * p + fv[1]]);
+							bndmat.push_back(2 * l + (x == 0 ? 1 : 2));
+						}
+					}
+				}
+			}
+}
@@ -0,0 +1,23 @@
+#ifndef __MESH3D__CUBE_MESH_H__
+#define __MESH3D__CUBE_MESH_H__
+
+#include "vector_mesh.h"
+
+namespace mesh3d {
+
+/** Structured tetrahedral mesh of a cube, used to produce meshes of arbitrary size
+*
+* The cube [0, size]^3 is divided into n^3 cells, each split into six tetrahedrons
+* sharing the cell main diagonal. Vertex (i, j, k) has index i + (n + 1) * (j + (n + 1) * k),
+* cell (i, j, k) holds tetrahedrons 6 * (i + n * (j + n * k)) .. + 5. Tetrahedrons have
+* material 1, boundary faces of x = 0, x = size, y = 0, y = size, z = 0, z = size
+* sides have materials 1 to 6 */
+class cube_mesh : public vector_mesh {
+public:
+	/** Generate mesh of n^3 cells with side length size */
+	cube_mesh(index n, double size = 1);
+};
+
+}
+
+#endif
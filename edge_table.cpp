@@ -0,0 +1,167 @@
+#include "edge_table.h"
+#include "mesh.h"
+#include "parallel.h"
+#include <algorithm>
+#include <stdexcept>
+#include <stdint.h>
+
+using namespace mesh3d;
+
+const int edge_table::tet_edge_verts[6][2] = {{0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3}};
+
+namespace mesh3d {
+
+namespace {
+
+const uint64_t EDGES_SIGNATURE = 0x0045474445544554ull;
+
+/** Local edge index of tetrahedron for every pair of its local vertices */
+const int tet_local_edge[4][4] = {{-1, 0, 1, 2}, {0, -1, 3, 4}, {1, 3, -1, 5}, {2, 4, 5, -1}};
+
+struct edge_key {
+	index a, b, id;
+};
+
+struct edge_key_less {
+	bool operator()(const edge_key &x, const edge_key &y) const {
+		if (x.a != y.a)
+			return x.a < y.a;
+		if (x.b != y.b)
+			return x.b < y.b;
+		return x.id < y.id;
+	}
+};
+
+template <class T>
+const T *data(const std::vector<T> &v) {
+	return v.empty() ? 0 : &v[0];
+}
+
+void write_array(std::ostream &o, const std::vector<index> &v) {
+	for (std::vector<index>::const_iterator it = v.begin(); it != v.end(); ++it) {
+		uint64_t x = *it;
+		o.write(reinterpret_cast<char *>(&x), sizeof(x));
+	}
+}
+
+/** Read n indices, each of them should be less than bound */
+void read_array(std::istream &is, std::vector<index> &v, uint64_t n, uint64_t bound) {
+	v.clear();
+	for (uint64_t i = 0; i < n; i++) {
+		uint64_t x;
+		if (!is.read(reinterpret_cast<char *>(&x), sizeof(x)))
+			throw std::invalid_argument("Unexpected end of edge table stream");
+		if (x >= bound)
+			throw std::domain_error("Edge table index is out of range");
+		v.push_back(static_cast<index>(x));
+	}
+}
+
+/** Read element count, checking that arity times count fits into index type */
+uint64_t read_count(std::istream &is, uint64_t arity) {
+	uint64_t n;
+	if (!is.read(reinterpret_cast<char *>(&n), sizeof(n)))
+		throw std::invalid_argument("Unexpected end of edge table stream");
+	if (n > (BAD_INDEX - 1) / arity)
+		throw std::domain_error("Edge table size does not fit into index type");
+	return n;
+}
+
+}
+
+}
+
+/*
+	Edge table binary format
+
+	u64 signature
+	u64 nV, nE, nT, nF
+	u64 edge_verts[nE][2]
+	u64 tet_edges[nT][6]
+	u64 face_edges[nF][3]
+*/
+edge_table::edge_table(const mesh &m) {
+	const index nV = m.vertices().size();
+	const index nT = m.tets().size();
+	const index nF = m.faces().size();
+
+	std::vector<edge_key> keys(6 * nT);
+#ifdef USE_OPENMP
+#	pragma omp parallel for num_threads(mesh3d::num_threads())
+#endif
+	for (index i = 0; i < nT; i++) {
+		const tetrahedron &tet = m.tets(i);
+		for (int j = 0; j < 6; j++) {
+			edge_key &k = keys[6 * i + j];
+			index a = tet.p(tet_edge_verts[j][0]).idx();
+			index b = tet.p(tet_edge_verts[j][1]).idx();
+			k.a = std::min(a, b);
+			k.b = std::max(a, b);
+			k.id = 6 * i + j;
+		}
+	}
+	std::sort(keys.begin(), keys.end(), edge_key_less());
+
+	_tet_edges.resize(6 * nT);
+	for (index k = 0; k < keys.size(); k++) {
+		if (k == 0 || keys[k].a != keys[k - 1].a || keys[k].b != keys[k - 1].b) {
+			_verts.push_back(keys[k].a);
+			_verts.push_back(keys[k].b);
+		}
+		_tet_edges[keys[k].id] = _verts.size() / 2 - 1;
+	}
+
+	_face_edges.resize(3 * nF);
+#ifdef USE_OPENMP
+#	pragma omp parallel for num_threads(mesh3d::num_threads())
+#endif
+	for (index i = 0; i < nF; i++) {
+		const face &f = m.faces(i);
+		const face &g = f.is_border() ? f.flip() : f;
+		const tetrahedron &tet = g.tet();
+		int li[3];
+		for (int j = 0; j < 3; j++)
+			for (int k = 0; k < 4; k++)
+				if (&tet.p(k) == &f.p(j))
+					li[j] = k;
+		for (int j = 0; j < 3; j++)
+			_face_edges[3 * i + j] = _tet_edges[6 * tet.idx() + tet_local_edge[li[j]][li[(j + 1) % 3]]];
+	}
+
+	build_incidence(nV);
+}
+
+edge_table::edge_table(std::istream &is) {
+	uint64_t sig;
+	is.read(reinterpret_cast<char *>(&sig), sizeof(sig));
+	if (!is || sig != EDGES_SIGNATURE)
+		throw std::invalid_argument("Invalid edge table signature");
+	const uint64_t nV = read_count(is, 1);
+	const uint64_t nE = read_count(is, 2);
+	const uint64_t nT = read_count(is, 6);
+	const uint64_t nF = read_count(is, 3);
+	read_array(is, _verts, 2 * nE, nV);
+	read_array(is, _tet_edges, 6 * nT, nE);
+	read_array(is, _face_edges, 3 * nF, nE);
+	build_incidence(nV);
+}
+
+void edge_table::serialize(std::ostream &o) const {
+	uint64_t hdr[5];
+	hdr[0] = EDGES_SIGNATURE;
+	hdr[1] = _vertex_edges.rows();
+	hdr[2] = num_edges();
+	hdr[3] = _tet_edges.size() / 6;
+	hdr[4] = _face_edges.size() / 3;
+	o.write(reinterpret_cast<char *>(hdr), sizeof(hdr));
+	write_array(o, _verts);
+	write_array(o, _tet_edges);
+	write_array(o, _face_edges);
+}
+
+void edge_table::build_incidence(index nV) {
+	const index nE = num_edges();
+	_vertex_edges.transpose(data(_verts), nE, 2, nV);
+	_edge_tets.transpose(data(_tet_edges), _tet_edges.size() / 6, 6, nE);
+	_edge_faces.transpose(data(_face_edges), _face_edges.size() / 3, 3, nE);
+}
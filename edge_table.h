@@ -0,0 +1,58 @@
+#ifndef __MESH3D__EDGE_TABLE_H__
+#define __MESH3D__EDGE_TABLE_H__
+
+#include "common.h"
+#include "csr.h"
+
+#include <vector>
+#include <istream>
+#include <ostream>
+
+namespace mesh3d {
+
+class mesh;
+
+/** A table of unique mesh edges with their incidences
+*
+* Edges are numbered in lexicographic order of their sorted vertex index pairs.
+* Tetrahedron and face edges are stored with fixed arity, vertex, tetrahedron and
+* face lists of every edge are stored as CSR tables. */
+class edge_table {
+	std::vector<index> _verts;
+	std::vector<index> _tet_edges;
+	std::vector<index> _face_edges;
+	csr _vertex_edges;
+	csr _edge_tets;
+	csr _edge_faces;
+
+	void build_incidence(index nV);
+public:
+	/** Local vertex indices of tetrahedron edges */
+	static const int tet_edge_verts[6][2];
+
+	/** Build edge table of mesh m */
+	edge_table(const mesh &m);
+	/** Read edge table from binary stream written by serialize */
+	edge_table(std::istream &i);
+	/** Write edge table to binary stream. Only edges and fixed arity tables are stored */
+	void serialize(std::ostream &o) const;
+
+	/** Return number of edges */
+	index num_edges() const { return _verts.size() / 2; }
+	/** Return two vertices of edge e, the first one has lesser index */
+	const index *edge_verts(index e) const { return &_verts[2 * e]; }
+	/** Return six edges of tetrahedron t, j-th one connects its tet_edge_verts[j] vertices */
+	const index *tet_edges(index t) const { return &_tet_edges[6 * t]; }
+	/** Return three edges of face f, j-th one connects its j-th and (j + 1) % 3-th vertices */
+	const index *face_edges(index f) const { return &_face_edges[3 * f]; }
+	/** Return edges of every vertex */
+	const csr &vertex_edges() const { return _vertex_edges; }
+	/** Return tetrahedrons of every edge */
+	const csr &edge_tets() const { return _edge_tets; }
+	/** Return faces of every edge, including border ones */
+	const csr &edge_faces() const { return _edge_faces; }
+};
+
+}
+
+#endif
@@ -7,18 +7,18 @@ namespace mesh3d {
 
 /** Represents mesh element. Every mesh element has index and color */
 class element {
-	index _color;
 	index _idx;
+	color_type _color;
 public:
 	/** Construct element with invalid color and index */
-	element() : _color(BAD_INDEX), _idx(BAD_INDEX) { }
+	element() : _idx(BAD_INDEX), _color(BAD_COLOR) { }
 	/** Get element index */
 	index idx() const {
 		return _idx;
 	}
 	/** Get element color */
 	index color() const {
-		return _color;
+		return _color == BAD_COLOR ? BAD_INDEX : _color;
 	}
 	/** Set element index */
 	void set_idx(index idx) {
@@ -26,7 +26,8 @@ public:
 	}
 	/** Set element color */
 	void set_color(index color) {
-		_color = color;
+		MESH3D_ASSERT(color == BAD_INDEX || color < BAD_COLOR);
+		_color = color == BAD_INDEX ? BAD_COLOR : static_cast<color_type>(color);
 	}
 };
 
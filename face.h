@@ -23,8 +23,10 @@ class face : public element {
 	face(const face &other);
 	face &operator =(const face &other);
 public:
-	/** Construct a face with three vertices p1, p2 and p3 and tetrahedron t */
-	face(vertex &p1, vertex &p2, vertex &p3, tetrahedron *t, int face_index) {
+	/** Construct a face with three vertices p1, p2 and p3 and tetrahedron t
+	*
+	* If geometry is false, normal, center and surface are left zero until update_geometry is called */
+	face(vertex &p1, vertex &p2, vertex &p3, tetrahedron *t, int face_index, bool geometry = true) {
 		_p[0] = &p1;
 		_p[1] = &p2;
 		_p[2] = &p3;
@@ -33,19 +35,30 @@ public:
 			_p[j]->add(this, j);
 
 		_tet = t;
+		_surface = 0;
 
-		_center += p1.r();
-		_center += p2.r();
-		_center += p3.r();
+		if (geometry)
+			update_geometry();
+
+		_flip = 0;
+		_tet_fi = face_index;
+	}
+
+	/** Compute normal, center and surface from vertex positions */
+	void update_geometry() {
+		const vector &r1 = _p[0]->r();
+		const vector &r2 = _p[1]->r();
+		const vector &r3 = _p[2]->r();
+
+		_center = r1;
+		_center += r2;
+		_center += r3;
 		_center *= 1.0 / 3;
 
-		_normal = (p2.r() - p1.r()) % (p3.r() - p1.r());
+		_normal = (r2 - r1) % (r3 - r1);
 
 		_surface = 0.5 * norm(_normal);
 		_normal *= 0.5 / _surface;
-
-		_flip = 0;
-		_tet_fi = face_index;
 	}
 	
 	/** Checks if face is a border face */
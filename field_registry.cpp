@@ -0,0 +1,161 @@
+#include "field_registry.h"
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+using namespace mesh3d;
+
+const size_t field::ALIGNMENT;
+
+field::field(const std::string &name, field_location loc, field_type type, int ncomp, index size)
+	: _name(name), _loc(loc), _type(type), _ncomp(ncomp), _size(size), _data(0)
+{
+	if (ncomp < 1)
+		throw std::invalid_argument("Field should have at least one component");
+	const size_t per_line = ALIGNMENT / type_size(type);
+	_stride = (size + per_line - 1) / per_line * per_line;
+	const size_t bytes = std::max<size_t>(_stride * ncomp * type_size(type), ALIGNMENT);
+	void *p;
+	if (posix_memalign(&p, ALIGNMENT, bytes) != 0)
+		throw std::bad_alloc();
+	_data = static_cast<char *>(p);
+	memset(_data, 0, bytes);
+}
+
+field::~field() {
+	free(_data);
+}
+
+size_t field::type_size(field_type t) {
+	switch (t) {
+		case FIELD_INT32: return sizeof(int32_t);
+		case FIELD_FLOAT: return sizeof(float);
+		case FIELD_DOUBLE: return sizeof(double);
+		default: throw std::invalid_argument("Invalid field type");
+	}
+}
+
+field_registry::field_registry() {
+	for (int k = 0; k < NUM_FIELD_LOCATIONS; k++)
+		_sizes[k] = 0;
+}
+
+field_registry::~field_registry() {
+	for (std::vector<field *>::iterator it = _fields.begin(); it != _fields.end(); ++it)
+		delete *it;
+}
+
+void field_registry::set_sizes(index nV, index nF, index nT) {
+	_sizes[VERTEX_FIELD] = nV;
+	_sizes[FACE_FIELD] = nF;
+	_sizes[TET_FIELD] = nT;
+}
+
+field &field_registry::add(const std::string &name, field_location loc, field_type type, int ncomp) {
+	if (find(name))
+		throw std::invalid_argument("Field `" + name + "' already exists");
+	if (loc < 0 || loc >= NUM_FIELD_LOCATIONS)
+		throw std::invalid_argument("Invalid field location");
+	field *f = new field(name, loc, type, ncomp, _sizes[loc]);
+	_fields.push_back(f);
+	return *f;
+}
+
+void field_registry::remove(const std::string &name) {
+	for (std::vector<field *>::iterator it = _fields.begin(); it != _fields.end(); ++it)
+		if ((*it)->name() == name) {
+			delete *it;
+			_fields.erase(it);
+			return;
+		}
+}
+
+field *field_registry::find(const std::string &name) {
+	for (std::vector<field *>::iterator it = _fields.begin(); it != _fields.end(); ++it)
+		if ((*it)->name() == name)
+			return *it;
+	return 0;
+}
+
+const field *field_registry::find(const std::string &name) const {
+	for (std::vector<field *>::const_iterator it = _fields.begin(); it != _fields.end(); ++it)
+		if ((*it)->name() == name)
+			return *it;
+	return 0;
+}
+
+void field_registry::swap(field_registry &other) {
+	_fields.swap(other._fields);
+	for (int k = 0; k < NUM_FIELD_LOCATIONS; k++)
+		std::swap(_sizes[k], other._sizes[k]);
+}
+
+void field_registry::assign_gather(const field_registry &src, const std::vector<index> *const maps[NUM_FIELD_LOCATIONS]) {
+	field_registry tmp;
+	tmp.set_sizes(maps[VERTEX_FIELD]->size(), maps[FACE_FIELD]->size(), maps[TET_FIELD]->size());
+	for (index k = 0; k < src.size(); k++) {
+		const field &s = src[k];
+		const std::vector<index> &map = *maps[s.location()];
+		field &d = tmp.add(s.name(), s.location(), s.type(), s.components());
+		const size_t w = field::type_size(s.type());
+		for (int c = 0; c < s.components(); c++) {
+			const char *from = static_cast<const char *>(s.raw(c));
+			char *to = static_cast<char *>(d.raw(c));
+			for (index i = 0; i < map.size(); i++)
+				if (map[i] != BAD_INDEX)
+					memcpy(to + i * w, from + map[i] * w, w);
+		}
+	}
+	swap(tmp);
+}
+
+/*
+	Fields format
+
+	u64 nF // number of fields
+	nF x {
+		u64 len // name length
+		char name[len]
+		u64 loc // field_location
+		u64 type // field_type
+		u64 ncomp // number of components
+		T values[ncomp][size] // component arrays without padding
+	}
+*/
+void field_registry::serialize(std::ostream &o) const {
+	uint64_t n = _fields.size();
+	o.write(reinterpret_cast<char *>(&n), sizeof(n));
+	for (index k = 0; k < size(); k++) {
+		const field &f = *_fields[k];
+		uint64_t hdr[4] = {f.name().size(), f.location(), f.type(), static_cast<uint64_t>(f.components())};
+		o.write(reinterpret_cast<char *>(&hdr[0]), sizeof(hdr[0]));
+		o.write(f.name().data(), f.name().size());
+		o.write(reinterpret_cast<char *>(&hdr[1]), 3 * sizeof(hdr[0]));
+		for (int c = 0; c < f.components(); c++)
+			o.write(static_cast<const char *>(f.raw(c)), f.size() * field::type_size(f.type()));
+	}
+}
+
+void field_registry::read(std::istream &is) {
+	field_registry tmp;
+	for (int k = 0; k < NUM_FIELD_LOCATIONS; k++)
+		tmp._sizes[k] = _sizes[k];
+	uint64_t n;
+	is.read(reinterpret_cast<char *>(&n), sizeof(n));
+	for (uint64_t k = 0; is && k < n; k++) {
+		uint64_t len, hdr[3];
+		is.read(reinterpret_cast<char *>(&len), sizeof(len));
+		std::string name(len, ' ');
+		if (len)
+			is.read(&name[0], len);
+		is.read(reinterpret_cast<char *>(&hdr[0]), sizeof(hdr));
+		if (!is || hdr[0] >= NUM_FIELD_LOCATIONS || hdr[1] > FIELD_DOUBLE || hdr[2] < 1)
+			throw std::invalid_argument("Invalid field record");
+		field &f = tmp.add(name, static_cast<field_location>(hdr[0]), static_cast<field_type>(hdr[1]), hdr[2]);
+		for (int c = 0; c < f.components(); c++)
+			is.read(static_cast<char *>(f.raw(c)), f.size() * field::type_size(f.type()));
+	}
+	if (!is)
+		throw std::invalid_argument("Unexpected end of field stream");
+	swap(tmp);
+}
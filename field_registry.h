@@ -0,0 +1,155 @@
+#ifndef __MESH3D__FIELD_REGISTRY_H__
+#define __MESH3D__FIELD_REGISTRY_H__
+
+#include "common.h"
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace mesh3d {
+
+/** Kind of mesh elements a field is attached to. Face fields cover every face, including border ones */
+enum field_location {
+	VERTEX_FIELD,
+	FACE_FIELD,
+	TET_FIELD,
+	NUM_FIELD_LOCATIONS
+};
+
+/** Value type of a field */
+enum field_type {
+	FIELD_INT32,
+	FIELD_FLOAT,
+	FIELD_DOUBLE
+};
+
+/** Maps C++ value types to field_type. Only int32_t, float and double are supported */
+template <class T> struct field_traits;
+template <> struct field_traits<int32_t> { static const field_type type = FIELD_INT32; };
+template <> struct field_traits<float> { static const field_type type = FIELD_FLOAT; };
+template <> struct field_traits<double> { static const field_type type = FIELD_DOUBLE; };
+
+/** A named array of values with one or more components for every element of some kind
+*
+* Components are stored in separate arrays (SoA), each of them aligned to 64 bytes.
+* Values are zero initialized */
+class field {
+	std::string _name;
+	field_location _loc;
+	field_type _type;
+	int _ncomp;
+	index _size;
+	index _stride;
+	char *_data;
+
+	field(const field &);
+	field &operator=(const field &);
+
+	void check_type(field_type t) const {
+		if (t != _type)
+			throw std::logic_error("Field `" + _name + "' has different value type");
+	}
+public:
+	/** Alignment of every component array in bytes */
+	static const size_t ALIGNMENT = 64;
+
+	/** Construct zero filled field of size elements */
+	field(const std::string &name, field_location loc, field_type type, int ncomp, index size);
+	/** Destroy field */
+	~field();
+
+	/** Return field name */
+	const std::string &name() const { return _name; }
+	/** Return kind of elements the field is attached to */
+	field_location location() const { return _loc; }
+	/** Return value type */
+	field_type type() const { return _type; }
+	/** Return number of components */
+	int components() const { return _ncomp; }
+	/** Return number of elements */
+	index size() const { return _size; }
+
+	/** Return size of field_type value in bytes */
+	static size_t type_size(field_type t);
+
+	/** Return c-th component array, T should match field type */
+	template <class T>
+	T *data(int c = 0) {
+		check_type(field_traits<T>::type);
+		return reinterpret_cast<T *>(raw(c));
+	}
+	/** Return c-th component array, T should match field type */
+	template <class T>
+	const T *data(int c = 0) const {
+		check_type(field_traits<T>::type);
+		return reinterpret_cast<const T *>(raw(c));
+	}
+	/** Return c-th component array as untyped memory */
+	void *raw(int c) { return _data + c * _stride * type_size(_type); }
+	/** Return c-th component array as untyped memory */
+	const void *raw(int c) const { return _data + c * _stride * type_size(_type); }
+};
+
+/** A set of named fields attached to mesh elements
+*
+* Mesh keeps element counts of the registry up to date, new fields get those sizes */
+class field_registry {
+	std::vector<field *> _fields;
+	index _sizes[NUM_FIELD_LOCATIONS];
+
+	field_registry(const field_registry &);
+	field_registry &operator=(const field_registry &);
+public:
+	/** Construct empty registry */
+	field_registry();
+	/** Destroy registry with its fields */
+	~field_registry();
+
+	/** Set element counts of every location */
+	void set_sizes(index nV, index nF, index nT);
+	/** Return element count of location */
+	index location_size(field_location loc) const { return _sizes[loc]; }
+
+	/** Add zero filled field of value type T. Throws if the name is taken */
+	template <class T>
+	field &add(const std::string &name, field_location loc, int ncomp = 1) {
+		return add(name, loc, field_traits<T>::type, ncomp);
+	}
+	/** Add zero filled field. Throws if the name is taken */
+	field &add(const std::string &name, field_location loc, field_type type, int ncomp = 1);
+	/** Remove field by name, if present */
+	void remove(const std::string &name);
+	/** Find field by name, return null if absent */
+	field *find(const std::string &name);
+	/** Find field by name, return null if absent */
+	const field *find(const std::string &name) const;
+
+	/** Return number of fields */
+	index size() const { return _fields.size(); }
+	/** Return i-th field, in order of addition */
+	field &operator[](index i) { return *_fields[i]; }
+	/** Return i-th field, in order of addition */
+	const field &operator[](index i) const { return *_fields[i]; }
+
+	/** Exchange contents with other registry */
+	void swap(field_registry &other);
+
+	/** Replace fields with values of src fields gathered by element maps
+	*
+	* maps[loc][i] is the src element of i-th element at loc, BAD_INDEX gives zero values.
+	* Element counts are taken from map sizes */
+	void assign_gather(const field_registry &src, const std::vector<index> *const maps[NUM_FIELD_LOCATIONS]);
+
+	/** Write fields to binary stream */
+	void serialize(std::ostream &o) const;
+	/** Read fields written by serialize, replacing the current ones. Sizes should be already set */
+	void read(std::istream &i);
+};
+
+}
+
+#endif
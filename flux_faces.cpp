@@ -0,0 +1,77 @@
+#include "flux_faces.h"
+#include "mesh.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace mesh3d;
+
+namespace mesh3d {
+
+namespace {
+
+struct border_order {
+	const mesh &m;
+	border_order(const mesh &m) : m(m) { }
+	bool operator()(const border_face &a, const border_face &b) const {
+		const index ca = m.faces(a.face).color(), cb = m.faces(b.face).color();
+		if (ca != cb)
+			return ca < cb;
+		if (a.tet != b.tet)
+			return a.tet < b.tet;
+		return a.face < b.face;
+	}
+};
+
+}
+
+}
+
+flux_faces::flux_faces(const mesh &m) {
+	if (!m.has_geometry())
+		throw std::logic_error("flux_faces: mesh geometry is not computed");
+
+	const index nT = m.tets().size();
+	const index nB = m.faces().size() - 4 * nT;
+	_inner.reserve((4 * nT - nB) / 2);
+	_border.reserve(nB);
+
+	/* Tet face normals point inside their tetrahedrons, flipped ones point outside */
+	for (index i = 0; i < nT; i++) {
+		const tetrahedron &tet = m.tets(i);
+		for (int j = 0; j < 4; j++) {
+			const face &f = tet.f(j);
+			const face &g = f.flip();
+			if (g.is_border()) {
+				border_face b;
+				b.tet = i;
+				b.face = g.idx();
+				b.normal = g.normal();
+				b.area = g.surface();
+				_border.push_back(b);
+				continue;
+			}
+			if (g.tet().idx() < i)
+				continue;
+			inner_face p;
+			p.left = i;
+			p.right = g.tet().idx();
+			p.face = f.idx();
+			p.normal = g.normal();
+			p.area = f.surface();
+			_inner.push_back(p);
+		}
+	}
+
+	std::sort(_border.begin(), _border.end(), border_order(m));
+	_color_ptr.push_back(0);
+	for (index k = 0; k < _border.size(); k++) {
+		const index c = m.faces(_border[k].face).color();
+		if (_colors.empty() || _colors.back() != c) {
+			if (!_colors.empty())
+				_color_ptr.push_back(k);
+			_colors.push_back(c);
+		}
+	}
+	if (!_colors.empty())
+		_color_ptr.push_back(_border.size());
+}
@@ -0,0 +1,59 @@
+#ifndef __MESH3D__FLUX_FACES_H__
+#define __MESH3D__FLUX_FACES_H__
+
+#include "common.h"
+#include "vector.h"
+
+#include <vector>
+
+namespace mesh3d {
+
+class mesh;
+
+/** Inner face shared by two tetrahedrons */
+struct inner_face {
+	index left; //!< tetrahedron with lesser index
+	index right; //!< tetrahedron with greater index
+	index face; //!< mesh face index of the face of left tetrahedron
+	vector normal; //!< unit normal directed from left to right
+	double area; //!< face surface
+};
+
+/** Border face of a tetrahedron */
+struct border_face {
+	index tet; //!< tetrahedron owning the face
+	index face; //!< mesh face index of the border face
+	vector normal; //!< unit normal directed outside of the domain
+	double area; //!< face surface
+};
+
+/** Face lists for finite volume flux loops visiting every face exactly once
+*
+* Inner faces are stored once per pair in order of their left tetrahedrons. Border faces
+* are grouped by color, groups are sorted by color and faces in them by tetrahedron */
+class flux_faces {
+	std::vector<inner_face> _inner;
+	std::vector<border_face> _border;
+	std::vector<index> _colors;
+	std::vector<index> _color_ptr;
+public:
+	/** Build face lists of mesh m. Mesh geometry should be computed */
+	flux_faces(const mesh &m);
+
+	/** Return inner faces */
+	const std::vector<inner_face> &inner() const { return _inner; }
+	/** Return border faces grouped by color */
+	const std::vector<border_face> &border() const { return _border; }
+	/** Return number of border color groups */
+	index groups() const { return _colors.size(); }
+	/** Return color of k-th border group */
+	index group_color(index k) const { return _colors[k]; }
+	/** Return first border face of k-th group */
+	index group_begin(index k) const { return _color_ptr[k]; }
+	/** Return past the last border face of k-th group */
+	index group_end(index k) const { return _color_ptr[k + 1]; }
+};
+
+}
+
+#endif
@@ -0,0 +1,281 @@
+#include "geometry.h"
+#include <cmath>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+# define MESH3D_X86_SIMD
+# include <immintrin.h>
+#endif
+
+using namespace mesh3d;
+
+/*
+	Every kernel repeats operations of face::update_geometry and tetrahedron::update_geometry
+	in the same order. The avx512f target implies FMA, so this file is built with
+	-ffp-contract=off to keep multiply-add chains unfused. Results are then bitwise equal
+	for every instruction set.
+*/
+
+namespace mesh3d {
+
+namespace {
+
+void face_scalar(index first, index last, const soa_coords &r, const index *v, const face_geometry &g) {
+	const double third = 1.0 / 3;
+	for (index i = first; i < last; i++) {
+		const index a = v[3 * i], b = v[3 * i + 1], c = v[3 * i + 2];
+		const double x1 = r.x[a], y1 = r.y[a], z1 = r.z[a];
+		const double x2 = r.x[b], y2 = r.y[b], z2 = r.z[b];
+		const double x3 = r.x[c], y3 = r.y[c], z3 = r.z[c];
+
+		g.cx[i] = (x1 + x2 + x3) * third;
+		g.cy[i] = (y1 + y2 + y3) * third;
+		g.cz[i] = (z1 + z2 + z3) * third;
+
+		const double ax = x2 - x1, ay = y2 - y1, az = z2 - z1;
+		const double bx = x3 - x1, by = y3 - y1, bz = z3 - z1;
+		double nx = ay * bz - az * by;
+		double ny = az * bx - ax * bz;
+		double nz = ax * by - ay * bx;
+
+		const double s = 0.5 * std::sqrt(nx * nx + ny * ny + nz * nz);
+		const double k = 0.5 / s;
+		g.nx[i] = nx * k;
+		g.ny[i] = ny * k;
+		g.nz[i] = nz * k;
+		g.surface[i] = s;
+	}
+}
+
+void tet_scalar(index first, index last, const soa_coords &r, const index *v, const tet_geometry &g) {
+	for (index i = first; i < last; i++) {
+		const index a = v[4 * i], b = v[4 * i + 1], c = v[4 * i + 2], d = v[4 * i + 3];
+		const double x1 = r.x[a], y1 = r.y[a], z1 = r.z[a];
+		const double x2 = r.x[b], y2 = r.y[b], z2 = r.z[b];
+		const double x3 = r.x[c], y3 = r.y[c], z3 = r.z[c];
+		const double x4 = r.x[d], y4 = r.y[d], z4 = r.z[d];
+
+		g.cx[i] = (x1 + x2 + x3 + x4) * 0.25;
+		g.cy[i] = (y1 + y2 + y3 + y4) * 0.25;
+		g.cz[i] = (z1 + z2 + z3 + z4) * 0.25;
+
+		const double ax = x1 - x4, ay = y1 - y4, az = z1 - z4;
+		const double bx = x2 - x4, by = y2 - y4, bz = z2 - z4;
+		const double cx = x3 - x4, cy = y3 - y4, cz = z3 - z4;
+		const double px = ay * bz - az * by;
+		const double py = az * bx - ax * bz;
+		const double pz = ax * by - ay * bx;
+
+		g.volume[i] = 1. / 6 * (cx * px + cy * py + cz * pz);
+	}
+}
+
+#ifdef MESH3D_X86_SIMD
+
+#define ADD _mm256_add_pd
+#define SUB _mm256_sub_pd
+#define MUL _mm256_mul_pd
+
+/* Vertex coordinates are loaded one by one instead of gather instructions,
+   which are microcoded and slow on many CPUs */
+__attribute__((target("avx2")))
+inline __m256d load4(const double *x, const index *v, index stride) {
+	return _mm256_set_pd(x[v[3 * stride]], x[v[2 * stride]], x[v[stride]], x[v[0]]);
+}
+
+__attribute__((target("avx2")))
+index face_avx2(index n, const soa_coords &r, const index *v, const face_geometry &g) {
+	const __m256d third = _mm256_set1_pd(1.0 / 3);
+	const __m256d half = _mm256_set1_pd(0.5);
+	index i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const index *a = v + 3 * i, *b = a + 1, *c = a + 2;
+		const __m256d x1 = load4(r.x, a, 3), y1 = load4(r.y, a, 3), z1 = load4(r.z, a, 3);
+		const __m256d x2 = load4(r.x, b, 3), y2 = load4(r.y, b, 3), z2 = load4(r.z, b, 3);
+		const __m256d x3 = load4(r.x, c, 3), y3 = load4(r.y, c, 3), z3 = load4(r.z, c, 3);
+
+		_mm256_storeu_pd(g.cx + i, MUL(ADD(ADD(x1, x2), x3), third));
+		_mm256_storeu_pd(g.cy + i, MUL(ADD(ADD(y1, y2), y3), third));
+		_mm256_storeu_pd(g.cz + i, MUL(ADD(ADD(z1, z2), z3), third));
+
+		const __m256d ax = SUB(x2, x1), ay = SUB(y2, y1), az = SUB(z2, z1);
+		const __m256d bx = SUB(x3, x1), by = SUB(y3, y1), bz = SUB(z3, z1);
+		const __m256d nx = SUB(MUL(ay, bz), MUL(az, by));
+		const __m256d ny = SUB(MUL(az, bx), MUL(ax, bz));
+		const __m256d nz = SUB(MUL(ax, by), MUL(ay, bx));
+
+		const __m256d s = MUL(half, _mm256_sqrt_pd(ADD(ADD(MUL(nx, nx), MUL(ny, ny)), MUL(nz, nz))));
+		const __m256d k = _mm256_div_pd(half, s);
+		_mm256_storeu_pd(g.nx + i, MUL(nx, k));
+		_mm256_storeu_pd(g.ny + i, MUL(ny, k));
+		_mm256_storeu_pd(g.nz + i, MUL(nz, k));
+		_mm256_storeu_pd(g.surface + i, s);
+	}
+	return i;
+}
+
+__attribute__((target("avx2")))
+index tet_avx2(index n, const soa_coords &r, const index *v, const tet_geometry &g) {
+	const __m256d quarter = _mm256_set1_pd(0.25);
+	const __m256d sixth = _mm256_set1_pd(1. / 6);
+	index i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const index *a = v + 4 * i, *b = a + 1, *c = a + 2, *d = a + 3;
+		const __m256d x1 = load4(r.x, a, 4), y1 = load4(r.y, a, 4), z1 = load4(r.z, a, 4);
+		const __m256d x2 = load4(r.x, b, 4), y2 = load4(r.y, b, 4), z2 = load4(r.z, b, 4);
+		const __m256d x3 = load4(r.x, c, 4), y3 = load4(r.y, c, 4), z3 = load4(r.z, c, 4);
+		const __m256d x4 = load4(r.x, d, 4), y4 = load4(r.y, d, 4), z4 = load4(r.z, d, 4);
+
+		_mm256_storeu_pd(g.cx + i, MUL(ADD(ADD(ADD(x1, x2), x3), x4), quarter));
+		_mm256_storeu_pd(g.cy + i, MUL(ADD(ADD(ADD(y1, y2), y3), y4), quarter));
+		_mm256_storeu_pd(g.cz + i, MUL(ADD(ADD(ADD(z1, z2), z3), z4), quarter));
+
+		const __m256d ax = SUB(x1, x4), ay = SUB(y1, y4), az = SUB(z1, z4);
+		const __m256d bx = SUB(x2, x4), by = SUB(y2, y4), bz = SUB(z2, z4);
+		const __m256d cx = SUB(x3, x4), cy = SUB(y3, y4), cz = SUB(z3, z4);
+		const __m256d px = SUB(MUL(ay, bz), MUL(az, by));
+		const __m256d py = SUB(MUL(az, bx), MUL(ax, bz));
+		const __m256d pz = SUB(MUL(ax, by), MUL(ay, bx));
+
+		_mm256_storeu_pd(g.volume + i, MUL(sixth, ADD(ADD(MUL(cx, px), MUL(cy, py)), MUL(cz, pz))));
+	}
+	return i;
+}
+
+#undef ADD
+#undef SUB
+#undef MUL
+
+#define ADD _mm512_add_pd
+#define SUB _mm512_sub_pd
+#define MUL _mm512_mul_pd
+
+__attribute__((target("avx512f")))
+inline __m512d load8(const double *x, const index *v, index stride) {
+	return _mm512_set_pd(
+		x[v[7 * stride]], x[v[6 * stride]], x[v[5 * stride]], x[v[4 * stride]],
+		x[v[3 * stride]], x[v[2 * stride]], x[v[stride]], x[v[0]]);
+}
+
+__attribute__((target("avx512f")))
+index face_avx512(index n, const soa_coords &r, const index *v, const face_geometry &g) {
+	const __m512d third = _mm512_set1_pd(1.0 / 3);
+	const __m512d half = _mm512_set1_pd(0.5);
+	index i = 0;
+	for (; i + 8 <= n; i += 8) {
+		const index *a = v + 3 * i, *b = a + 1, *c = a + 2;
+		const __m512d x1 = load8(r.x, a, 3), y1 = load8(r.y, a, 3), z1 = load8(r.z, a, 3);
+		const __m512d x2 = load8(r.x, b, 3), y2 = load8(r.y, b, 3), z2 = load8(r.z, b, 3);
+		const __m512d x3 = load8(r.x, c, 3), y3 = load8(r.y, c, 3), z3 = load8(r.z, c, 3);
+
+		_mm512_storeu_pd(g.cx + i, MUL(ADD(ADD(x1, x2), x3), third));
+		_mm512_storeu_pd(g.cy + i, MUL(ADD(ADD(y1, y2), y3), third));
+		_mm512_storeu_pd(g.cz + i, MUL(ADD(ADD(z1, z2), z3), third));
+
+		const __m512d ax = SUB(x2, x1), ay = SUB(y2, y1), az = SUB(z2, z1);
+		const __m512d bx = SUB(x3, x1), by = SUB(y3, y1), bz = SUB(z3, z1);
+		const __m512d nx = SUB(MUL(ay, bz), MUL(az, by));
+		const __m512d ny = SUB(MUL(az, bx), MUL(ax, bz));
+		const __m512d nz = SUB(MUL(ax, by), MUL(ay, bx));
+
+		/* Masked form avoids an undefined source operand of _mm512_sqrt_pd */
+		const __m512d nn = ADD(ADD(MUL(nx, nx), MUL(ny, ny)), MUL(nz, nz));
+		const __m512d s = MUL(half, _mm512_mask_sqrt_pd(nn, 0xff, nn));
+		const __m512d k = _mm512_div_pd(half, s);
+		_mm512_storeu_pd(g.nx + i, MUL(nx, k));
+		_mm512_storeu_pd(g.ny + i, MUL(ny, k));
+		_mm512_storeu_pd(g.nz + i, MUL(nz, k));
+		_mm512_storeu_pd(g.surface + i, s);
+	}
+	return i;
+}
+
+__attribute__((target("avx512f")))
+index tet_avx512(index n, const soa_coords &r, const index *v, const tet_geometry &g) {
+	const __m512d quarter = _mm512_set1_pd(0.25);
+	const __m512d sixth = _mm512_set1_pd(1. / 6);
+	index i = 0;
+	for (; i + 8 <= n; i += 8) {
+		const index *a = v + 4 * i, *b = a + 1, *c = a + 2, *d = a + 3;
+		const __m512d x1 = load8(r.x, a, 4), y1 = load8(r.y, a, 4), z1 = load8(r.z, a, 4);
+		const __m512d x2 = load8(r.x, b, 4), y2 = load8(r.y, b, 4), z2 = load8(r.z, b, 4);
+		const __m512d x3 = load8(r.x, c, 4), y3 = load8(r.y, c, 4), z3 = load8(r.z, c, 4);
+		const __m512d x4 = load8(r.x, d, 4), y4 = load8(r.y, d, 4), z4 = load8(r.z, d, 4);
+
+		_mm512_storeu_pd(g.cx + i, MUL(ADD(ADD(ADD(x1, x2), x3), x4), quarter));
+		_mm512_storeu_pd(g.cy + i, MUL(ADD(ADD(ADD(y1, y2), y3), y4), quarter));
+		_mm512_storeu_pd(g.cz + i, MUL(ADD(ADD(ADD(z1, z2), z3), z4), quarter));
+
+		const __m512d ax = SUB(x1, x4), ay = SUB(y1, y4), az = SUB(z1, z4);
+		const __m512d bx = SUB(x2, x4), by = SUB(y2, y4), bz = SUB(z2, z4);
+		const __m512d cx = SUB(x3, x4), cy = SUB(y3, y4), cz = SUB(z3, z4);
+		const __m512d px = SUB(MUL(ay, bz), MUL(az, by));
+		const __m512d py = SUB(MUL(az, bx), MUL(ax, bz));
+		const __m512d pz = SUB(MUL(ax, by), MUL(ay, bx));
+
+		_mm512_storeu_pd(g.volume + i, MUL(sixth, ADD(ADD(MUL(cx, px), MUL(cy, py)), MUL(cz, pz))));
+	}
+	return i;
+}
+
+#undef ADD
+#undef SUB
+#undef MUL
+
+#endif
+
+simd_level effective_level(simd_level level) {
+	simd_level best = best_simd_level();
+	return level > best ? best : level;
+}
+
+}
+
+}
+
+simd_level mesh3d::best_simd_level() {
+#ifdef MESH3D_X86_SIMD
+	if (__builtin_cpu_supports("avx512f"))
+		return SIMD_AVX512;
+	if (__builtin_cpu_supports("avx2"))
+		return SIMD_AVX2;
+#endif
+	return SIMD_SCALAR;
+}
+
+void mesh3d::compute_face_geometry(index n, const soa_coords &r, const index *verts,
+	const face_geometry &out, simd_level level)
+{
+	index done = 0;
+	switch (effective_level(level)) {
+#ifdef MESH3D_X86_SIMD
+		case SIMD_AVX512:
+			done = face_avx512(n, r, verts, out);
+			break;
+		case SIMD_AVX2:
+			done = face_avx2(n, r, verts, out);
+			break;
+#endif
+		default:
+			break;
+	}
+	face_scalar(done, n, r, verts, out);
+}
+
+void mesh3d::compute_tet_geometry(index n, const soa_coords &r, const index *verts,
+	const tet_geometry &out, simd_level level)
+{
+	index done = 0;
+	switch (effective_level(level)) {
+#ifdef MESH3D_X86_SIMD
+		case SIMD_AVX512:
+			done = tet_avx512(n, r, verts, out);
+			break;
+		case SIMD_AVX2:
+			done = tet_avx2(n, r, verts, out);
+			break;
+#endif
+		default:
+			break;
+	}
+	tet_scalar(done, n, r, verts, out);
+}
@@ -0,0 +1,59 @@
+#ifndef __MESH3D__GEOMETRY_H__
+#define __MESH3D__GEOMETRY_H__
+
+#include "common.h"
+
+namespace mesh3d {
+
+/** Instruction set used by batch geometry kernels */
+enum simd_level {
+	SIMD_SCALAR = 0, //!< Plain scalar code
+	SIMD_AVX2 = 1, //!< AVX2, four doubles per operation
+	SIMD_AVX512 = 2, //!< AVX-512F, eight doubles per operation
+	SIMD_AUTO = 3 //!< Best level supported by the CPU
+};
+
+/** Return best instruction set supported by the CPU and the library build */
+simd_level best_simd_level();
+
+/** Vertex coordinates in structure of arrays layout */
+struct soa_coords {
+	const double *x; //!< x coordinates
+	const double *y; //!< y coordinates
+	const double *z; //!< z coordinates
+};
+
+/** Output arrays for face geometry, n elements each */
+struct face_geometry {
+	double *nx; //!< unit normal x component
+	double *ny; //!< unit normal y component
+	double *nz; //!< unit normal z component
+	double *cx; //!< center x coordinate
+	double *cy; //!< center y coordinate
+	double *cz; //!< center z coordinate
+	double *surface; //!< face surface
+};
+
+/** Output arrays for tetrahedron geometry, n elements each */
+struct tet_geometry {
+	double *cx; //!< center x coordinate
+	double *cy; //!< center y coordinate
+	double *cz; //!< center z coordinate
+	double *volume; //!< tetrahedron volume
+};
+
+/** Compute geometry of n faces with vertices verts[3 * i + j]
+*
+* Results are bitwise equal to face::update_geometry for every simd level */
+void compute_face_geometry(index n, const soa_coords &r, const index *verts,
+	const face_geometry &out, simd_level level = SIMD_AUTO);
+
+/** Compute geometry of n tetrahedrons with vertices verts[4 * i + j]
+*
+* Results are bitwise equal to tetrahedron::update_geometry for every simd level */
+void compute_tet_geometry(index n, const soa_coords &r, const index *verts,
+	const tet_geometry &out, simd_level level = SIMD_AUTO);
+
+}
+
+#endif
@@ -0,0 +1,186 @@
+#include "instrument.h"
+#include <time.h>
+
+using namespace mesh3d;
+
+namespace mesh3d {
+
+namespace {
+
+/* Allocation totals live in static storage, so they are valid before any constructor runs */
+uint64_t total_allocs;
+uint64_t total_frees;
+uint64_t total_bytes;
+uint64_t live_bytes;
+uint64_t peak_bytes;
+
+typedef std::map<std::string, region_stats> region_map;
+typedef std::map<std::string, uint64_t> counter_map;
+
+region_map &regions() {
+	static region_map r;
+	return r;
+}
+
+counter_map &counters() {
+	static counter_map c;
+	return c;
+}
+
+double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+void write_string(std::ostream &o, const std::string &s) {
+	o << '"';
+	for (std::string::const_iterator it = s.begin(); it != s.end(); ++it) {
+		if (*it == '"' || *it == '\\')
+			o << '\\';
+		o << *it;
+	}
+	o << '"';
+}
+
+}
+
+}
+
+bool mesh3d::instrument_enabled() {
+#ifdef MESH3D_INSTRUMENT
+	return true;
+#else
+	return false;
+#endif
+}
+
+std::map<std::string, region_stats> mesh3d::instrument_regions() {
+	region_map ret;
+#ifdef USE_OPENMP
+#	pragma omp critical(mesh3d_instrument)
+#endif
+	ret = regions();
+	return ret;
+}
+
+std::map<std::string, uint64_t> mesh3d::instrument_counters() {
+	counter_map ret;
+#ifdef USE_OPENMP
+#	pragma omp critical(mesh3d_instrument)
+#endif
+	ret = counters();
+	return ret;
+}
+
+alloc_stats mesh3d::instrument_allocs() {
+	alloc_stats s;
+	s.allocs = total_allocs;
+	s.frees = total_frees;
+	s.bytes = total_bytes;
+	s.live_bytes = live_bytes;
+	s.peak_bytes = peak_bytes;
+	return s;
+}
+
+void mesh3d::instrument_reset() {
+#ifdef USE_OPENMP
+#	pragma omp critical(mesh3d_instrument)
+#endif
+	{
+		regions().clear();
+		counters().clear();
+	}
+	total_allocs = 0;
+	total_frees = 0;
+	total_bytes = 0;
+	peak_bytes = live_bytes;
+}
+
+void mesh3d::instrument_record_alloc(size_t n) {
+#ifdef MESH3D_INSTRUMENT
+	__sync_fetch_and_add(&total_allocs, 1);
+	__sync_fetch_and_add(&total_bytes, n);
+	uint64_t live = __sync_add_and_fetch(&live_bytes, n);
+	uint64_t peak = peak_bytes;
+	while (live > peak) {
+		uint64_t prev = __sync_val_compare_and_swap(&peak_bytes, peak, live);
+		if (prev == peak)
+			break;
+		peak = prev;
+	}
+#else
+	(void)n;
+#endif
+}
+
+void mesh3d::instrument_record_free(size_t n) {
+#ifdef MESH3D_INSTRUMENT
+	__sync_fetch_and_add(&total_frees, 1);
+	__sync_fetch_and_sub(&live_bytes, n);
+#else
+	(void)n;
+#endif
+}
+
+void mesh3d::instrument_count(const char *name, uint64_t n) {
+#ifdef USE_OPENMP
+#	pragma omp critical(mesh3d_instrument)
+#endif
+	counters()[name] += n;
+}
+
+/*
+	{"enabled": bool,
+	 "regions": {name: {"calls", "seconds", "allocs", "alloc_bytes"}, ...},
+	 "counters": {name: value, ...},
+	 "allocations": {"allocs", "frees", "bytes", "live_bytes", "peak_bytes"}}
+*/
+void mesh3d::instrument_dump(std::ostream &o) {
+	const region_map r = instrument_regions();
+	const counter_map c = instrument_counters();
+	const alloc_stats a = instrument_allocs();
+
+	o << "{\"enabled\": " << (instrument_enabled() ? "true" : "false") << ", \"regions\": {";
+	for (region_map::const_iterator it = r.begin(); it != r.end(); ++it) {
+		if (it != r.begin())
+			o << ", ";
+		write_string(o, it->first);
+		o << ": {\"calls\": " << it->second.calls
+			<< ", \"seconds\": " << it->second.seconds
+			<< ", \"allocs\": " << it->second.allocs
+			<< ", \"alloc_bytes\": " << it->second.alloc_bytes << "}";
+	}
+	o << "}, \"counters\": {";
+	for (counter_map::const_iterator it = c.begin(); it != c.end(); ++it) {
+		if (it != c.begin())
+			o << ", ";
+		write_string(o, it->first);
+		o << ": " << it->second;
+	}
+	o << "}, \"allocations\": {\"allocs\": " << a.allocs
+		<< ", \"frees\": " << a.frees
+		<< ", \"bytes\": " << a.bytes
+		<< ", \"live_bytes\": " << a.live_bytes
+		<< ", \"peak_bytes\": " << a.peak_bytes << "}}";
+}
+
+scoped_timer::scoped_timer(const char *name)
+	: name(name), start(now()), allocs(total_allocs), bytes(total_bytes)
+{ }
+
+scoped_timer::~scoped_timer() {
+	const double dt = now() - start;
+	const uint64_t da = total_allocs - allocs;
+	const uint64_t db = total_bytes - bytes;
+#ifdef USE_OPENMP
+#	pragma omp critical(mesh3d_instrument)
+#endif
+	{
+		region_stats &s = regions()[name];
+		s.calls++;
+		s.seconds += dt;
+		s.allocs += da;
+		s.alloc_bytes += db;
+	}
+}
@@ -0,0 +1,97 @@
+#ifndef __MESH3D__INSTRUMENT_H__
+#define __MESH3D__INSTRUMENT_H__
+
+#include "common.h"
+
+#include <map>
+#include <string>
+#include <ostream>
+
+namespace mesh3d {
+
+/** Accumulated statistics of a named instrumented region */
+struct region_stats {
+	uint64_t calls; //!< number of times the region was entered
+	double seconds; //!< total wall time spent in the region
+	uint64_t allocs; //!< number of allocations made while in the region, by any thread
+	uint64_t alloc_bytes; //!< number of bytes allocated while in the region
+
+	region_stats() : calls(0), seconds(0), allocs(0), alloc_bytes(0) { }
+};
+
+/** Process wide operator new statistics
+*
+* Allocations are only counted if the application links mesh3d_alloc_hooks, which replaces
+* global operator new and delete, and the library is built with MESH3D_INSTRUMENT */
+struct alloc_stats {
+	uint64_t allocs; //!< number of allocations
+	uint64_t frees; //!< number of deallocations
+	uint64_t bytes; //!< total number of bytes allocated
+	uint64_t live_bytes; //!< number of bytes currently allocated
+	uint64_t peak_bytes; //!< maximum of live_bytes
+
+	alloc_stats() : allocs(0), frees(0), bytes(0), live_bytes(0), peak_bytes(0) { }
+};
+
+/** Return true if the library was built with MESH3D_INSTRUMENT */
+bool instrument_enabled();
+
+/** Return statistics of every region entered so far, by name */
+std::map<std::string, region_stats> instrument_regions();
+
+/** Return every counter value, by name */
+std::map<std::string, uint64_t> instrument_counters();
+
+/** Return allocation statistics, see alloc_stats */
+alloc_stats instrument_allocs();
+
+/** Record allocation of n bytes. Called by allocation hooks, does nothing unless instrumented */
+void instrument_record_alloc(size_t n);
+
+/** Record deallocation of n bytes. Called by allocation hooks, does nothing unless instrumented */
+void instrument_record_free(size_t n);
+
+/** Clear regions, counters and allocation totals. Live bytes are kept */
+void instrument_reset();
+
+/** Write regions, counters and allocation statistics as a JSON object */
+void instrument_dump(std::ostream &o);
+
+/** Add n to counter name */
+void instrument_count(const char *name, uint64_t n);
+
+/** Timer adding wall time and allocations between its construction and destruction to a region
+*
+* Nested regions are inclusive. Use MESH3D_TIMED_SCOPE instead, it is compiled out
+* unless built with MESH3D_INSTRUMENT */
+class scoped_timer {
+	const char *name;
+	double start;
+	uint64_t allocs;
+	uint64_t bytes;
+
+	scoped_timer(const scoped_timer &);
+	scoped_timer &operator=(const scoped_timer &);
+public:
+	/** Enter region name. The name should be a string literal */
+	explicit scoped_timer(const char *name);
+	/** Leave the region */
+	~scoped_timer();
+};
+
+}
+
+#define MESH3D_INSTRUMENT_CONCAT2(a, b) a ## b
+#define MESH3D_INSTRUMENT_CONCAT(a, b) MESH3D_INSTRUMENT_CONCAT2(a, b)
+
+#ifdef MESH3D_INSTRUMENT
+/** Time the rest of the enclosing scope as region name */
+#	define MESH3D_TIMED_SCOPE(name) mesh3d::scoped_timer MESH3D_INSTRUMENT_CONCAT(mesh3d_timer_, __LINE__)(name)
+/** Add n to counter name */
+#	define MESH3D_COUNT(name, n) mesh3d::instrument_count(name, n)
+#else
+#	define MESH3D_TIMED_SCOPE(name) ((void)0)
+#	define MESH3D_COUNT(name, n) ((void)0)
+#endif
+
+#endif
@@ -1,12 +1,101 @@
 #include "mesh.h"
+#include "parallel.h"
+#include "instrument.h"
+#include "array_mesh.h"
 #include <sstream>
 #include <stdexcept>
 #include <iostream>
 #include <stdint.h>
+#include <algorithm>
+#include <cmath>
 
 using namespace mesh3d;
 
 const uint64_t MESH3D_SIGNATURE = 0x004853454d544554ull;
+const uint64_t MESH3D_SIGNATURE_V1 = 0x014853454d544554ull;
+const uint64_t MESH3D_SIGNATURE_V2 = 0x024853454d544554ull;
+const uint64_t MESH_HAS_FIELDS = 1;
+const uint64_t FIELDS_SIGNATURE = 0x444c454946544554ull;
+
+namespace mesh3d {
+
+namespace {
+
+bool valid_width(uint64_t w) {
+	return w == 2 || w == 4 || w == 8;
+}
+
+/** Read little endian unsigned integer of width bytes, all ones are read as BAD_INDEX */
+index read_uint(std::istream &is, int width) {
+	uint64_t x = 0;
+	is.read(reinterpret_cast<char *>(&x), width);
+	const uint64_t ones = width == 8 ? ~0ull : (1ull << (8 * width)) - 1;
+	if (x == ones)
+		return BAD_INDEX;
+	if (x >= BAD_INDEX)
+		throw std::domain_error("Mesh index does not fit into index type");
+	return static_cast<index>(x);
+}
+
+index read_color(std::istream &is, int width) {
+	const index c = read_uint(is, width);
+	if (c != BAD_INDEX && c >= BAD_COLOR)
+		throw std::domain_error("Mesh color does not fit into color type");
+	return c;
+}
+
+/** Return material of a simple_mesh element, checking it fits into color type */
+index material_color(index mat) {
+	if (mat != BAD_INDEX && mat >= BAD_COLOR)
+		throw std::domain_error("Material does not fit into color type");
+	return mat;
+}
+
+/** Write little endian unsigned integer of width bytes, BAD_INDEX is written as all ones */
+void write_uint(std::ostream &os, index v, int width) {
+	uint64_t x = v == BAD_INDEX ? ~0ull : v;
+	os.write(reinterpret_cast<char *>(&x), width);
+}
+
+/** Element access of mesh::build through simple_mesh virtual calls */
+class virtual_source {
+	const simple_mesh &sm;
+public:
+	virtual_source(const simple_mesh &sm) : sm(sm) { }
+	index num_vertices() const { return sm.num_vertices(); }
+	index num_tetrahedrons() const { return sm.num_tetrahedrons(); }
+	index num_bnd_faces() const { return sm.num_bnd_faces(); }
+	const double *vertex_coord(index i) const { return sm.vertex_coord(i); }
+	const index *tet_verts(index i) const { return sm.tet_verts(i); }
+	const index *bnd_verts(index i) const { return sm.bnd_verts(i); }
+	index tet_material(index i) const { return sm.tet_material(i); }
+	index bnd_material(index i) const { return sm.bnd_material(i); }
+};
+
+/** Element access of mesh::build directly to array_mesh arrays, calls are inlined */
+class array_source {
+	index nV, nT, nB;
+	const double *vert;
+	const index *tet, *tetmat, *bnd, *bndmat;
+public:
+	array_source(const array_mesh &am)
+		: nV(am.num_vertices()), nT(am.num_tetrahedrons()), nB(am.num_bnd_faces()),
+		vert(am.vertex_array()), tet(am.tet_array()), tetmat(am.tet_material_array()),
+		bnd(am.bnd_array()), bndmat(am.bnd_material_array())
+	{ }
+	index num_vertices() const { return nV; }
+	index num_tetrahedrons() const { return nT; }
+	index num_bnd_faces() const { return nB; }
+	const double *vertex_coord(index i) const { return vert + 3 * i; }
+	const index *tet_verts(index i) const { return tet + 4 * i; }
+	const index *bnd_verts(index i) const { return bnd + 3 * i; }
+	index tet_material(index i) const { return tetmat[i]; }
+	index bnd_material(index i) const { return bndmat[i]; }
+};
+
+}
+
+}
 
 typedef std::vector<face_vertex>::const_iterator face_iter_t;
 
@@ -35,13 +124,15 @@ const face *three_way_find_except(face_iter_t x, face_iter_t y, face_iter_t z, c
 }
 
 #ifdef USE_METIS
-mesh::mesh(const mesh &m, index dom, const tet_graph &tg) {
+mesh::mesh(const mesh &m, index dom, const tet_graph &tg, bool geometry) {
+	MESH3D_TIMED_SCOPE("mesh::extract");
 	_domain = dom;
+	_geometry = geometry;
 	_domains = tg.mapping().size();
 
 	typedef std::map<index, index> mapping_t;
 	mapping_t tg2l;
-	std::vector<index> tl2g;
+	std::vector<index> tl2g, vl2g, fl2g;
 	const mapping_t &g2l = tg.mapping()[dom];
 	
 	for (mapping_t::const_iterator it = g2l.begin();
@@ -50,6 +141,7 @@ mesh::mesh(const mesh &m, index dom, const tet_graph &tg) {
 		const vertex &v = m.vertices(it->first);
 		_vertices.push_back(new vertex(v.r()));
 		_vertices.back().set_color(v.color());
+		vl2g.push_back(it->first);
 	}
 
 	index nT = m.tets().size();
@@ -62,11 +154,12 @@ mesh::mesh(const mesh &m, index dom, const tet_graph &tg) {
 			v[j] = g2l.find(tet.p(j).idx())->second;
 		_tets.push_back(new tetrahedron(
 			_vertices[v[0]], _vertices[v[1]], 
-			_vertices[v[2]], _vertices[v[3]]));
+			_vertices[v[2]], _vertices[v[3]], geometry));
 		_tets[i].set_color(tet.color());
 		for (int j = 0; j < 4; j++) {
 			_faces.push_back(&_tets[i].f(j));
 			_tets[i].f(j).set_color(tet.f(j).color());
+			fl2g.push_back(tet.f(j).idx());
 		}
 		tg2l[k] = i;
 		tl2g.push_back(k);
@@ -75,6 +168,8 @@ mesh::mesh(const mesh &m, index dom, const tet_graph &tg) {
 	nT = tl2g.size();
 
 	index b[3];
+	std::vector<index> alias_verts;
+	std::vector<dom_vertex> alias_data;
 	for (index i = 0; i < nT; i++) {
 		index gi = tl2g[i];
 		const tetrahedron &tet = m.tets(gi);
@@ -83,26 +178,30 @@ mesh::mesh(const mesh &m, index dom, const tet_graph &tg) {
 			for (int k = 0; k < 3; k++) {
 				index gi = f.p(k).idx();
 				b[k] = g2l.find(gi)->second;
-				vertex &vx = _vertices[b[k]];
 				for (index d = 0; d < tg.mapping().size(); d++) {
 					if (d == dom)
 						continue;
 					const mapping_t &dmap = tg.mapping()[d];
 					mapping_t::const_iterator mit = dmap.find(gi);
-					if (mit != dmap.end())
-						vx.add(d, mit->second);
+					if (mit != dmap.end()) {
+						alias_verts.push_back(b[k]);
+						alias_data.push_back(dom_vertex(d, mit->second));
+					}
 				}
 			}
 			if (f.is_border() || static_cast<index>(tg.colors(f.tet().idx())) != dom) {
 				_faces.push_back(new face(
-					_vertices[b[0]], _vertices[b[1]], _vertices[b[2]], 0, -1));
+					_vertices[b[0]], _vertices[b[1]], _vertices[b[2]], 0, -1, geometry));
 				_faces.back().set_color(f.color());
 				_faces.back().set_flip(_tets[i].f(j));
+				fl2g.push_back(f.idx());
 				_tets[i].f(j).set_flip(_faces.back());
 			} 
 		}
 	}
 
+	_aliases.assign(alias_verts, alias_data);
+
 	for (index i = 0; i < nT; i++) {
 		index gi = tl2g[i];
 		const tetrahedron &tet = m.tets(gi);
@@ -124,43 +223,55 @@ mesh::mesh(const mesh &m, index dom, const tet_graph &tg) {
 
 	for (index i = 0; i < _faces.size(); i++)
 		_faces[i].set_idx(i);
+
+	const std::vector<index> *maps[NUM_FIELD_LOCATIONS] = {&vl2g, &fl2g, &tl2g};
+	_fields.assign_gather(m.fields(), maps);
 }
 #endif
 
-mesh::mesh(const simple_mesh &sm, index dom, index domains) {
-	_domain = dom;
-	_domains = domains;
-	index nV = sm.num_vertices();
-	for (index i = 0; i < nV; i++) {
-		const double *p = sm.vertex_coord(i);
-		_vertices.push_back(new vertex(vector(p[0], p[1], p[2])));
-		_vertices[i].set_color(BAD_INDEX);
-	}
+template <class S>
+void mesh::build(const S &src, bool geometry) {
+	const index nV = src.num_vertices();
+	const index nT = src.num_tetrahedrons();
+	const index nB = src.num_bnd_faces();
+	MESH3D_COUNT("mesh::build.vertices", nV);
+	MESH3D_COUNT("mesh::build.tets", nT);
+	MESH3D_COUNT("mesh::build.bnd_faces", nB);
 
-	index nT = sm.num_tetrahedrons();
-	for (index i = 0; i < nT; i++) {
-		const index *v = sm.tet_verts(i);
-		_tets.push_back(new tetrahedron(
-			_vertices[v[0]], _vertices[v[1]], 
-			_vertices[v[2]], _vertices[v[3]]));
-		_tets[i].set_color(sm.tet_material(i));
-		for (int j = 0; j < 4; j++) {
-			_faces.push_back(&_tets[i].f(j));
-			_tets[i].f(j).set_color(BAD_INDEX);
+	{
+		MESH3D_TIMED_SCOPE("mesh::build.elements");
+		for (index i = 0; i < nV; i++) {
+			const double *p = src.vertex_coord(i);
+			_vertices.push_back(new vertex(vector(p[0], p[1], p[2])));
+			_vertices[i].set_color(BAD_INDEX);
 		}
-	}
 
-	index nB = sm.num_bnd_faces();
-	for (index i = 0; i < nB; i++) {
-		const index *v = sm.bnd_verts(i);
-		_faces.push_back(new face(
-			_vertices[v[0]], _vertices[v[1]], _vertices[v[2]], 0, -1));
-		_faces[i].set_color(sm.bnd_material(i));
+		for (index i = 0; i < nT; i++) {
+			const index *v = src.tet_verts(i);
+			_tets.push_back(new tetrahedron(
+				_vertices[v[0]], _vertices[v[1]], 
+				_vertices[v[2]], _vertices[v[3]], geometry));
+			_tets[i].set_color(material_color(src.tet_material(i)));
+			for (int j = 0; j < 4; j++) {
+				_faces.push_back(&_tets[i].f(j));
+				_tets[i].f(j).set_color(BAD_INDEX);
+			}
+		}
+
+		for (index i = 0; i < nB; i++) {
+			const index *v = src.bnd_verts(i);
+			_faces.push_back(new face(
+				_vertices[v[0]], _vertices[v[1]], _vertices[v[2]], 0, -1, geometry));
+			_faces.back().set_color(material_color(src.bnd_material(i)));
+		}
 	}
 
-	for (index i = 0; i < nV; i++) {
-		_vertices[i].set_idx(i);
-		_vertices[i].sort_lists();
+	{
+		MESH3D_TIMED_SCOPE("mesh::build.sort_lists");
+		for (index i = 0; i < nV; i++) {
+			_vertices[i].set_idx(i);
+			_vertices[i].sort_lists();
+		}
 	}
 
 	for (index i = 0; i < nT; i++)
@@ -171,52 +282,97 @@ mesh::mesh(const simple_mesh &sm, index dom, index domains) {
 	for (index i = 0; i < nF; i++)
 		_faces[i].set_idx(i);
 
-	for (index i = 0; i < nF; i++) {
-		face *f = &_faces[i];
-		const std::vector<face_vertex> &f1 = f->p(0).faces();
-		const std::vector<face_vertex> &f2 = f->p(1).faces();
-		const std::vector<face_vertex> &f3 = f->p(2).faces();
-
-		const face *flip = three_way_find_except(f1.begin(), f2.begin(), f3.begin(), f);
-		f->set_flip(const_cast<face &>(*flip));
+	{
+		MESH3D_TIMED_SCOPE("mesh::build.flip_search");
+		for (index i = 0; i < nF; i++) {
+			face *f = &_faces[i];
+			const std::vector<face_vertex> &f1 = f->p(0).faces();
+			const std::vector<face_vertex> &f2 = f->p(1).faces();
+			const std::vector<face_vertex> &f3 = f->p(2).faces();
+
+			const face *flip = three_way_find_except(f1.begin(), f2.begin(), f3.begin(), f);
+			f->set_flip(const_cast<face &>(*flip));
+		}
 	}
+
+	_fields.set_sizes(nV, nF, nT);
+}
+
+mesh::mesh(const simple_mesh &sm, index dom, index domains, bool geometry) {
+	MESH3D_TIMED_SCOPE("mesh::build");
+	_domain = dom;
+	_domains = domains;
+	_geometry = geometry;
+	const array_mesh *am = dynamic_cast<const array_mesh *>(&sm);
+	if (am)
+		build(array_source(*am), geometry);
+	else
+		build(virtual_source(sm), geometry);
 }
 
 /*
 	Mesh format
 
-	u64 sig // signature - TETMESH\0
+	u64 sig // signature - TETMESH\0, TETMESH\1 or TETMESH\2
+	u64 iw, cw // only for TETMESH\1 and TETMESH\2: index and color width in bytes
+	u64 flags // only for TETMESH\2: 1 if fields follow the mesh
 	u64 dom // domain #
+	u64 doms // domain count
 	u64 nV // vertex #
 	u64 nT // tets #
 	u64 nB // boundary faces #
 	u64 nI // interface vertex #
 	f64 vertex[3xnV] // vertex x, y, z
-	u64 tets[4xnT] // tet vertex ids
-	u64 bnds[3xnB] // bnd faces vertex ids
-	s64 vcol[nV] // vertex color
-	s64 tcol[nT] // tet color
-	s64 fcol[4xnT+nB] // face color
-	u64 flips[4xnT+nB] // flipped faces
+	uI tets[4xnT] // tet vertex ids
+	uI bnds[3xnB] // bnd faces vertex ids
+	uC vcol[nV] // vertex color
+	uC tcol[nT] // tet color
+	uC fcol[4xnT+nB] // face color
+	uI flips[4xnT+nB] // flipped faces
 	nI x {
-		u64 idx // vertex id
-		u64 nA // number of aliases for this vertex
+		uI idx // vertex id
+		uI nA // number of aliases for this vertex
 		nA x {
-			u64 other_domain
-			u64 remote_idx
+			uI other_domain
+			uI remote_idx
 		}
 	}
+
+	TETMESH\0 files have 64-bit indices and colors, uI and uC are u64. Otherwise uI and uC are
+	unsigned integers of iw and cw bytes. Absent colors are stored as all ones, -1 for u64.
+	Meshes without fields are written with TETMESH\0 unless built with narrower index or color
+	types, then TETMESH\1 is used. Meshes with fields are written with TETMESH\2 and the fields
+	follow as u64 TETFIELD signature and field_registry records. The header tells whether
+	fields follow, so the reader never looks past the mesh record
 */
-mesh::mesh(std::istream &is) {
+mesh::mesh(std::istream &is, bool geometry) {
+	MESH3D_TIMED_SCOPE("mesh::read");
 	uint64_t sig;
 	uint64_t nV, nT, nB, nI, dom, doms;
 	double p[3];
-	uint64_t v[4];
-	uint64_t b[3];
+	index v[4];
+	index b[3];
+	uint64_t flags = 0;
+	int iw = 8, cw = 8;
+
+	_geometry = geometry;
 
 	is.read(reinterpret_cast<char *>(&sig), sizeof(sig));
-	if (sig != MESH3D_SIGNATURE)
+	if (sig != MESH3D_SIGNATURE && sig != MESH3D_SIGNATURE_V1 && sig != MESH3D_SIGNATURE_V2)
 		throw std::invalid_argument("Invalid mesh file signature");
+	if (sig != MESH3D_SIGNATURE) {
+		uint64_t w[2];
+		is.read(reinterpret_cast<char *>(&w[0]), sizeof(w));
+		if (!valid_width(w[0]) || !valid_width(w[1]))
+			throw std::invalid_argument("Invalid mesh file index or color width");
+		iw = w[0];
+		cw = w[1];
+	}
+	if (sig == MESH3D_SIGNATURE_V2) {
+		is.read(reinterpret_cast<char *>(&flags), sizeof(flags));
+		if (flags & ~MESH_HAS_FIELDS)
+			throw std::invalid_argument("Unknown mesh file flags");
+	}
 	is.read(reinterpret_cast<char *>(&dom), sizeof(dom));
 	_domain = dom;
 	is.read(reinterpret_cast<char *>(&doms), sizeof(doms));
@@ -225,77 +381,93 @@ mesh::mesh(std::istream &is) {
 	is.read(reinterpret_cast<char *>(&nT), sizeof(nT));
 	is.read(reinterpret_cast<char *>(&nB), sizeof(nB));
 	is.read(reinterpret_cast<char *>(&nI), sizeof(nI));
+	if (nV >= BAD_INDEX || 4 * nT + nB >= BAD_INDEX)
+		throw std::domain_error("Mesh is too large for index type");
+	MESH3D_COUNT("mesh::read.vertices", nV);
+	MESH3D_COUNT("mesh::read.tets", nT);
+	MESH3D_COUNT("mesh::read.bnd_faces", nB);
 	for (uint64_t i = 0; i < nV; i++) {
 		is.read(reinterpret_cast<char *>(&p[0]), sizeof(p));
 		_vertices.push_back(new vertex(vector(p[0], p[1], p[2])));
 	}
 	for (uint64_t i = 0; i < nT; i++) {
-		is.read(reinterpret_cast<char *>(&v[0]), sizeof(v));
+		for (int j = 0; j < 4; j++)
+			v[j] = read_uint(is, iw);
 		_tets.push_back(new tetrahedron(
 			_vertices[v[0]], _vertices[v[1]], 
-			_vertices[v[2]], _vertices[v[3]]));
+			_vertices[v[2]], _vertices[v[3]], geometry));
 		_tets[i].set_idx(i);
 		for (int j = 0; j < 4; j++)
 			_faces.push_back(&_tets[i].f(j));
 	}
 	for (uint64_t i = 0; i < nB; i++) {
-		is.read(reinterpret_cast<char *>(&b[0]), sizeof(b));
+		for (int j = 0; j < 3; j++)
+			b[j] = read_uint(is, iw);
 		_faces.push_back(new face(
-			_vertices[b[0]], _vertices[b[1]], _vertices[b[2]], 0, -1));
+			_vertices[b[0]], _vertices[b[1]], _vertices[b[2]], 0, -1, geometry));
 	}
 	for (uint64_t i = 0; i < nV; i++) {
-		int64_t col;
-		is.read(reinterpret_cast<char *>(&col), sizeof(col));
-		_vertices[i].set_color(col);
+		_vertices[i].set_color(read_color(is, cw));
 		_vertices[i].set_idx(i);
 	}
 	for (uint64_t i = 0; i < nT; i++) {
-		int64_t col;
-		is.read(reinterpret_cast<char *>(&col), sizeof(col));
-		_tets[i].set_color(col);
+		_tets[i].set_color(read_color(is, cw));
 		_tets[i].set_idx(i);
 	}
 	for (uint64_t i = 0; i < 4 * nT + nB; i++) {
-		int64_t col;
-		is.read(reinterpret_cast<char *>(&col), sizeof(col));
-		_faces[i].set_color(col);
+		_faces[i].set_color(read_color(is, cw));
 		_faces[i].set_idx(i);
 	}
-	for (uint64_t i = 0; i < 4 * nT + nB; i++) {
-		uint64_t flip;
-		is.read(reinterpret_cast<char *>(&flip), sizeof(flip));
-		_faces[i].set_flip(_faces[flip]);
-	}
+	for (uint64_t i = 0; i < 4 * nT + nB; i++)
+		_faces[i].set_flip(_faces[read_uint(is, iw)]);
+	std::vector<index> alias_verts;
+	std::vector<dom_vertex> alias_data;
 	for (uint64_t i = 0; i < nI; i++) {
-		uint64_t vi, nA;
-		is.read(reinterpret_cast<char *>(&vi), sizeof(vi));
-		is.read(reinterpret_cast<char *>(&nA), sizeof(nA));
-		for (uint64_t j = 0; j < nA; j++) {
-			uint64_t did, rid;
-			is.read(reinterpret_cast<char *>(&did), sizeof(did));
-			is.read(reinterpret_cast<char *>(&rid), sizeof(rid));
-			_vertices[vi].add(did, rid);
+		const index vi = read_uint(is, iw);
+		const index nA = read_uint(is, iw);
+		for (index j = 0; j < nA; j++) {
+			const index did = read_uint(is, iw);
+			const index rid = read_uint(is, iw);
+			alias_verts.push_back(vi);
+			alias_data.push_back(dom_vertex(did, rid));
 		}
 	}
+	_aliases.assign(alias_verts, alias_data);
+
+	_fields.set_sizes(nV, 4 * nT + nB, nT);
+	if (flags & MESH_HAS_FIELDS) {
+		uint64_t fsig;
+		is.read(reinterpret_cast<char *>(&fsig), sizeof(fsig));
+		if (!is || fsig != FIELDS_SIGNATURE)
+			throw std::invalid_argument("Invalid mesh fields signature");
+		_fields.read(is);
+	}
 }
 
 void mesh::serialize(std::ostream &os) const {
-	uint64_t sig = MESH3D_SIGNATURE;
+	MESH3D_TIMED_SCOPE("mesh::serialize");
+	const bool wide = sizeof(index) == 8 && sizeof(color_type) == 8;
+	const bool has_fields = _fields.size() > 0;
+	const int iw = sizeof(index), cw = sizeof(color_type);
+	uint64_t sig = has_fields ? MESH3D_SIGNATURE_V2 : wide ? MESH3D_SIGNATURE : MESH3D_SIGNATURE_V1;
 	uint64_t nV, nT, nB, nI;
 	uint64_t dom = _domain, doms = _domains;
 	double p[3];
-	uint64_t v[4];
-	uint64_t b[3];
 
 	nV = _vertices.size();
 	nT = _tets.size();
 	nB = _faces.size() - 4 * nT;
-	nI = 0;
-	for (uint64_t i = 0; i < nV; i++)
-		if (_vertices[i].aliases().size() > 0)
-			nI++;
+	nI = _aliases.size();
 
 	os.write(reinterpret_cast<char *>(&sig), sizeof(sig));
+	if (sig != MESH3D_SIGNATURE) {
+		uint64_t w[2] = {sizeof(index), sizeof(color_type)};
+		os.write(reinterpret_cast<char *>(&w[0]), sizeof(w));
+	}
+	if (sig == MESH3D_SIGNATURE_V2) {
+		uint64_t flags = MESH_HAS_FIELDS;
+		os.write(reinterpret_cast<char *>(&flags), sizeof(flags));
+	}
 	os.write(reinterpret_cast<char *>(&dom), sizeof(dom));
 	os.write(reinterpret_cast<char *>(&doms), sizeof(doms));
 	os.write(reinterpret_cast<char *>(&nV), sizeof(nV));
@@ -312,47 +484,35 @@ void mesh::serialize(std::ostream &os) const {
 	for (uint64_t i = 0; i < nT; i++) {
 		const tetrahedron &tet = _tets[i];
 		for (int j = 0; j < 4; j++)
-			v[j] = tet.p(j).idx();
-		os.write(reinterpret_cast<char *>(&v[0]), sizeof(v));
+			write_uint(os, tet.p(j).idx(), iw);
 	}
 	for (uint64_t i = 0; i < nB; i++) {
 		const face &f = _faces[4 * nT + i];
 		for (int j = 0; j < 3; j++)
-			b[j] = f.p(j).idx();
-		os.write(reinterpret_cast<char *>(&b[0]), sizeof(b));
-	}
-	for (uint64_t i = 0; i < nV; i++) {
-		int64_t col = _vertices[i].color();
-		os.write(reinterpret_cast<char *>(&col), sizeof(col));
+			write_uint(os, f.p(j).idx(), iw);
 	}
-	for (uint64_t i = 0; i < nT; i++) {
-		int64_t col = _tets[i].color();
-		os.write(reinterpret_cast<char *>(&col), sizeof(col));
-	}
-	for (uint64_t i = 0; i < 4 * nT + nB; i++) {
-		int64_t col = _faces[i].color();
-		os.write(reinterpret_cast<char *>(&col), sizeof(col));
-	}
-	for (uint64_t i = 0; i < 4 * nT + nB; i++) {
-		uint64_t flip = _faces[i].flip().idx();
-		os.write(reinterpret_cast<char *>(&flip), sizeof(flip));
-	}
-	for (uint64_t i = 0; i < nV; i++) {
-		uint64_t nA = _vertices[i].aliases().size();
-		if (nA == 0)
-			continue;
-		os.write(reinterpret_cast<char *>(&i), sizeof(i));
-		os.write(reinterpret_cast<char *>(&nA), sizeof(nA));
-		for (std::map<index, index>::const_iterator it = _vertices[i].aliases().begin();
-			it != _vertices[i].aliases().end(); ++it)
-		{
-			uint64_t did, rid;
-			did = it->first;
-			rid = it->second;
-			os.write(reinterpret_cast<char *>(&did), sizeof(did));
-			os.write(reinterpret_cast<char *>(&rid), sizeof(rid));
+	for (uint64_t i = 0; i < nV; i++)
+		write_uint(os, _vertices[i].color(), cw);
+	for (uint64_t i = 0; i < nT; i++)
+		write_uint(os, _tets[i].color(), cw);
+	for (uint64_t i = 0; i < 4 * nT + nB; i++)
+		write_uint(os, _faces[i].color(), cw);
+	for (uint64_t i = 0; i < 4 * nT + nB; i++)
+		write_uint(os, _faces[i].flip().idx(), iw);
+	for (uint64_t k = 0; k < nI; k++) {
+		const alias_list al = _aliases.row(k);
+		write_uint(os, _aliases.vertices()[k], iw);
+		write_uint(os, al.size(), iw);
+		for (alias_list::const_iterator it = al.begin(); it != al.end(); ++it) {
+			write_uint(os, it->domain_id, iw);
+			write_uint(os, it->remote_idx, iw);
 		}
 	}
+	if (has_fields) {
+		uint64_t fsig = FIELDS_SIGNATURE;
+		os.write(reinterpret_cast<char *>(&fsig), sizeof(fsig));
+		_fields.serialize(os);
+	}
 }
 
 void mesh::dump(std::ostream &os) const {
@@ -365,10 +525,7 @@ void mesh::dump(std::ostream &os) const {
 	nV = _vertices.size();
 	nT = _tets.size();
 	nB = _faces.size() - 4 * nT;
-	nI = 0;
-	for (uint64_t i = 0; i < nV; i++)
-		if (_vertices[i].aliases().size() > 0)
-			nI++;
+	nI = _aliases.size();
 
 	os << "Mesh dump" << std::endl;
 	os << "Domain #" << dom << " of " << doms << std::endl;
@@ -427,17 +584,13 @@ void mesh::dump(std::ostream &os) const {
 	}
 
 	os << "Aliases: " << std::endl;
-	for (uint64_t i = 0; i < nV; i++) {
-		uint64_t nA = _vertices[i].aliases().size();
-		if (nA == 0)
-			continue;
-		os << i << ". ";
-		for (std::map<index, index>::const_iterator it = _vertices[i].aliases().begin();
-			it != _vertices[i].aliases().end(); ++it)
-		{
+	for (uint64_t k = 0; k < nI; k++) {
+		const alias_list al = _aliases.row(k);
+		os << _aliases.vertices()[k] << ". ";
+		for (alias_list::const_iterator it = al.begin(); it != al.end(); ++it) {
 			uint64_t did, rid;
-			did = it->first;
-			rid = it->second;
+			did = it->domain_id;
+			rid = it->remote_idx;
 			os << "(" << did << ":" << rid << ") ";
 		}
 		os << std::endl;
@@ -446,250 +599,255 @@ void mesh::dump(std::ostream &os) const {
 
 mesh::~mesh() { }
 
-struct string_adder {
-	std::stringstream ss;
-	template<class T>
-	string_adder &operator +(const T &val) { ss << val; return *this; }
-	operator std::string() { return ss.str(); }
-};
-
-#define _ string_adder()
+#if __cplusplus >= 201103L
+mesh::mesh(mesh &&other) : _domain(0), _domains(1), _geometry(false) {
+	swap(other);
+}
 
-void mesh::log(std::ostream *o, const std::string &msg) const {
-	if (!o)
-		return;
-	*o << msg << std::endl;
+mesh &mesh::operator=(mesh &&other) {
+	mesh tmp(static_cast<mesh &&>(other));
+	swap(tmp);
+	return *this;
 }
+#endif
 
-bool mesh::check(std::ostream *o) const {
-	bool ok = true, lastcheck;
-	index wrong;
-
-	index nT = _tets.size();
-	index nF = _faces.size();
-
-	ok &= lastcheck = (_domain < _domains);
-	if (!lastcheck)
-		log(o, _ + "Domain number " + _domain + " is not less than domain count " + _domains);
-
-	ok &= lastcheck = checkVertexIndices(wrong);
-	if (!lastcheck)
-		log(o, _ + "Vertex #" + wrong + " has wrong index");
-
-	ok &= lastcheck = checkFaceIndices(wrong);
-	if (!lastcheck)
-		log(o, _ + "Face #" + wrong + " has wrong index");
-
-	ok &= lastcheck = checkTetIndices(wrong);
-	if (!lastcheck)
-		log(o, _ + "Tet #" + wrong + " has wrong index");
-
-	ok &= lastcheck = checkFlippedFace(wrong);
-	if (!lastcheck)
-		log(o, _ + "Face #" + wrong + " twice filpped is not the same");
-
-	ok &= lastcheck = checkFlippedOrient(wrong);
-	if (!lastcheck)
-		log(o, _ + "Face #" + wrong + " flip not opposed to face (probably wrong oriented face)");
-
-	ok &= lastcheck = checkFaceSurface(wrong);
-	if (!lastcheck)
-		log(o, _ + "Face #" + wrong + " has negative surface = " + _faces[wrong].surface());
-
-	ok &= lastcheck = checkTetVolume(wrong);
-	if (!lastcheck)
-		log(o, _ + "Tet #" + wrong + " has negative volume = " + _tets[wrong].volume());
-
-	int fno;
-	ok &= lastcheck = checkTetFaceNormals(wrong, fno);
-	if (!lastcheck)
-		log(o, _ + "Tet #" + wrong + " has " + fno + "-th face improperly oriented");
-
-	index faceno, tetno, cnt;
-	int vertno;
-	ok &= lastcheck = checkVertexTetList(wrong, tetno, vertno, cnt);
-	if (!lastcheck)
-		log(o, _ + "Tet #" + tetno + " has " + vertno + "-th vertex incorrectly listed in vertex #" + wrong + " _tets list");
-
-	lastcheck = (cnt == 4 * nT);
-	ok &= lastcheck;
-	if (!lastcheck)
-		log(o, _ + "Total elems list has wrong size " + cnt + " != " + (4 * nT));
-
-	ok &= lastcheck = checkVertexFaceList(wrong, faceno, vertno, cnt);
-	if (!lastcheck)
-		log(o, _ + "Face #" + faceno + " has " + vertno + "-th vertex " +
-			"incorrectly listed in vertex #" + wrong + " _faces list");
-
-	lastcheck = (cnt == 3 * nF);
-	ok &= lastcheck;
-	if (!lastcheck)
-		log(o, _ + "Total _faces list has wrong size " + cnt + " != " + (3 * nF));
-
-	return ok;
+void mesh::swap(mesh &other) {
+	_vertices.swap(other._vertices);
+	_faces.swap(other._faces);
+	_tets.swap(other._tets);
+	_aliases.swap(other._aliases);
+	_fields.swap(other._fields);
+	std::swap(_domain, other._domain);
+	std::swap(_domains, other._domains);
+	std::swap(_geometry, other._geometry);
 }
 
-bool mesh::checkVertexIndices(index &wrong) const {
-	index nV = _vertices.size();
+namespace mesh3d {
 
-	for (index i = 0; i < nV; i++)
-		if (_vertices[i].idx() != i) {
-			wrong = i;
-			return false;
-		}
-	wrong = BAD_INDEX;
-	return true;
-}
+namespace {
+
+/** Recompute geometry of elements v[idx[i]], or v[i] if idx is null */
+template <class E>
+struct geometry_update {
+	ptr_vector<E> &v;
+	const index *idx;
+	geometry_update(ptr_vector<E> &v, const index *idx = 0) : v(v), idx(idx) { }
+	void operator()(index i) const { v[idx ? idx[i] : i].update_geometry(); }
+};
 
-bool mesh::checkFaceIndices(index &wrong) const {
-	index nF = _faces.size();
+struct position_update {
+	ptr_vector<vertex> &v;
+	const index *idx;
+	const vector *r;
+	position_update(ptr_vector<vertex> &v, const index *idx, const vector *r) : v(v), idx(idx), r(r) { }
+	void operator()(index i) const { v[idx[i]].set_r(r[i]); }
+};
 
-	for (index i = 0; i < nF; i++)
-		if (_faces[i].idx() != i) {
-			wrong = i;
-			return false;
-		}
-	wrong = BAD_INDEX;
-	return true;
 }
 
-bool mesh::checkTetIndices(index &wrong) const {
-	index nT = _tets.size();
+}
 
-	for (index i = 0; i < nT; i++)
-		if (_tets[i].idx() != i) {
-			wrong = i;
-			return false;
-		}
-	wrong = BAD_INDEX;
-	return true;
+void mesh::update_geometry() {
+	MESH3D_TIMED_SCOPE("mesh::update_geometry");
+	parallel_for(_faces.size(), geometry_update<face>(_faces));
+	parallel_for(_tets.size(), geometry_update<tetrahedron>(_tets));
+
+	_geometry = true;
 }
 
-bool mesh::checkFlippedFace(index &wrong) const {
-	index nF = _faces.size();
+void mesh::move_vertices(index n, const index *verts, const vector *r, std::vector<index> *inverted) {
+	const index nV = _vertices.size();
 
-	for (index i = 0; i < nF; i++)
-		if (&_faces[i].flip().flip() != &_faces[i]) {
-			wrong = i;
-			return false;
-		}
-	wrong = BAD_INDEX;
-	return true;
+	for (index i = 0; i < n; i++)
+		if (verts[i] >= nV)
+			throw std::invalid_argument("Vertex index is out of range");
+
+	parallel_for(n, position_update(_vertices, verts, r));
+
+	if (inverted)
+		inverted->clear();
+	if (!_geometry)
+		return;
+
+	std::vector<index> dirty_faces, dirty_tets;
+	for (index i = 0; i < n; i++) {
+		const vertex &v = _vertices[verts[i]];
+		for (std::vector<face_vertex>::const_iterator it = v.faces().begin(); it != v.faces().end(); ++it)
+			dirty_faces.push_back(it->f->idx());
+		for (std::vector<tet_vertex>::const_iterator it = v.tetrahedrons().begin(); it != v.tetrahedrons().end(); ++it)
+			dirty_tets.push_back(it->t->idx());
+	}
+	std::sort(dirty_faces.begin(), dirty_faces.end());
+	dirty_faces.erase(std::unique(dirty_faces.begin(), dirty_faces.end()), dirty_faces.end());
+	std::sort(dirty_tets.begin(), dirty_tets.end());
+	dirty_tets.erase(std::unique(dirty_tets.begin(), dirty_tets.end()), dirty_tets.end());
+
+	const index nF = dirty_faces.size();
+	const index nT = dirty_tets.size();
+
+	if (nF)
+		parallel_for(nF, geometry_update<face>(_faces, &dirty_faces[0]));
+	if (nT)
+		parallel_for(nT, geometry_update<tetrahedron>(_tets, &dirty_tets[0]));
+
+	if (inverted)
+		for (index i = 0; i < nT; i++)
+			if (_tets[dirty_tets[i]].volume() <= 0)
+				inverted->push_back(dirty_tets[i]);
 }
 
-bool mesh::checkFlippedOrient(index &wrong) const {
-	index nF = _faces.size();
+namespace mesh3d {
 
-	for (index i = 0; i < nF; i++) {
-		double cosv = _faces[i].flip().normal().dot(_faces[i].normal());
-		if (std::fabs(cosv + 1) > 1e-10) {
-			wrong = i;
-			return false;
-		}
+namespace {
+
+/** Thread local storage for found problems */
+struct error_sink {
+	std::vector<check_error> errors;
+	index total;
+	index cap;
+	error_sink(index cap) : total(0), cap(cap) { }
+	void add(const check_error &e) {
+		total++;
+		if (errors.size() < cap)
+			errors.push_back(e);
 	}
-	wrong = BAD_INDEX;
-	return true;
+};
+
+int sweep_of(check_error::kind_t kind) {
+	if (kind < check_error::TET_INDEX)
+		return 0;
+	if (kind < check_error::VERTEX_INDEX)
+		return 1;
+	return 2;
 }
 
-bool mesh::checkFaceSurface(index &wrong) const {
-	index nF = _faces.size();
+/* Every thread stores problems in this order, so the first max_errors problems
+   of merged lists do not depend on how the sweeps were split between threads */
+struct check_error_less {
+	bool operator()(const check_error &a, const check_error &b) const {
+		int sa = sweep_of(a.kind), sb = sweep_of(b.kind);
+		if (sa != sb)
+			return sa < sb;
+		if (a.element != b.element)
+			return a.element < b.element;
+		return a.kind < b.kind;
+	}
+};
 
-	for (index i = 0; i < nF; i++)
-		if (_faces[i].surface() <= 0) {
-			wrong = i;
-			return false;
-		}
-	wrong = BAD_INDEX;
-	return true;
 }
 
-bool mesh::checkTetVolume(index &wrong) const {
-	index nT = _tets.size();
+}
 
-	for (index i = 0; i < nT; i++)
-		if (_tets[i].volume() <= 0) {
-			wrong = i;
-			return false;
-		}
-	wrong = BAD_INDEX;
-	return true;
+bool mesh::check(std::ostream *o) const {
+	MESH3D_TIMED_SCOPE("mesh::check");
+	check_report r = validate(CHECK_FULL);
+	if (o)
+		r.print(*o);
+	return r.ok();
 }
 
-bool mesh::checkTetFaceNormals(index &wrong, int &faceno) const {
-	index nT = _tets.size();
+check_report mesh::validate(check_level level, index max_errors) const {
+	MESH3D_TIMED_SCOPE("mesh::validate");
+	const bool geom = level == CHECK_FULL && _geometry;
+	const index nV = _vertices.size();
+	const index nF = _faces.size();
+	const index nT = _tets.size();
 
-	for (index i = 0; i < nT; i++) {
-		for (int j = 0; j < 4; j++) {
-			vector r = (1.0 / 3) * _tets[i].f(j).surface() * (_tets[i].p(j).r() - _tets[i].f(j).center());
-			double fv = r.dot(_tets[i].f(j).normal());
-			if (std::fabs(fv - _tets[i].volume()) > 
-				1e-12 * std::fabs(_tets[i].volume())) 
-			{
-				wrong = i;
-				faceno = j;
-				return false;
-			}
-		}
-	}
+	check_report report;
+	index tet_cnt = 0, face_cnt = 0;
 
-	wrong = BAD_INDEX;
-	faceno = -1;
+	const bool bad_domain = _domain >= _domains;
+	if (bad_domain)
+		report.errors.push_back(check_error(check_error::DOMAIN_NUMBER, _domain, _domains));
 
-	return true;
-}
+#ifdef USE_OPENMP
+#	pragma omp parallel reduction(+:tet_cnt, face_cnt) num_threads(mesh3d::num_threads())
+#endif
+	{
+		error_sink sink(max_errors);
 
-bool mesh::checkVertexTetList(index &wrong, index &tetno, int &vertno, index &cnt) const {
-	bool check, ret = true;
-	index nV = _vertices.size();
-	cnt = 0;
-	vertno = -1;
-	tetno = BAD_INDEX;
-	wrong = BAD_INDEX;
-
-	for (index i = 0; i < nV; i++) {
-		const std::vector<tet_vertex> &vl = _vertices[i].tetrahedrons();
-		for (std::vector<tet_vertex>::const_iterator it = vl.begin();
-			it != vl.end(); ++it)
-		{
-			cnt++;
-			const tetrahedron *tet = it->t;
-			check = &tet->p(it->li) == &_vertices[i];
-			if (!check) {
-				wrong = i;
-				tetno = tet->idx();
-				vertno = it->li;
-				ret = false;
+#ifdef USE_OPENMP
+#	pragma omp for schedule(static) nowait
+#endif
+		for (index i = 0; i < nF; i++) {
+			const face &f = _faces[i];
+			if (f.idx() != i)
+				sink.add(check_error(check_error::FACE_INDEX, i));
+			if (&f.flip().flip() != &f)
+				sink.add(check_error(check_error::FACE_FLIP, i));
+			if (!geom)
+				continue;
+			if (std::fabs(f.flip().normal().dot(f.normal()) + 1) > 1e-10)
+				sink.add(check_error(check_error::FACE_FLIP_ORIENT, i));
+			if (f.surface() <= 0)
+				sink.add(check_error(check_error::FACE_SURFACE, i, BAD_INDEX, -1, f.surface()));
+		}
+
+#ifdef USE_OPENMP
+#	pragma omp for schedule(static) nowait
+#endif
+		for (index i = 0; i < nT; i++) {
+			const tetrahedron &tet = _tets[i];
+			if (tet.idx() != i)
+				sink.add(check_error(check_error::TET_INDEX, i));
+			if (!geom)
+				continue;
+			if (tet.volume() <= 0)
+				sink.add(check_error(check_error::TET_VOLUME, i, BAD_INDEX, -1, tet.volume()));
+			for (int j = 0; j < 4; j++) {
+				const face &f = tet.f(j);
+				vector r = (1.0 / 3) * f.surface() * (tet.p(j).r() - f.center());
+				double fv = r.dot(f.normal());
+				if (std::fabs(fv - tet.volume()) > 1e-12 * std::fabs(tet.volume()))
+					sink.add(check_error(check_error::TET_FACE_NORMAL, i, BAD_INDEX, j));
 			}
 		}
-	}
-	return ret;
-}
 
-bool mesh::checkVertexFaceList(index &wrong, index &faceno, int &vertno, index &cnt) const {
-	bool check, ret = true;
-	index nV = _vertices.size();
-	cnt = 0;
-	vertno = -1;
-	faceno = BAD_INDEX;
-	wrong = BAD_INDEX;
-
-	for (index i = 0; i < nV; i++) {
-		const std::vector<face_vertex> &vl = _vertices[i].faces();
-		for (std::vector<face_vertex>::const_iterator it = vl.begin();
-			it != vl.end(); ++it)
+#ifdef USE_OPENMP
+#	pragma omp for schedule(static) nowait
+#endif
+		for (index i = 0; i < nV; i++) {
+			const vertex &v = _vertices[i];
+			if (v.idx() != i)
+				sink.add(check_error(check_error::VERTEX_INDEX, i));
+			const std::vector<tet_vertex> &tl = v.tetrahedrons();
+			for (std::vector<tet_vertex>::const_iterator it = tl.begin(); it != tl.end(); ++it)
+				if (&it->t->p(it->li) != &v)
+					sink.add(check_error(check_error::VERTEX_TET_LIST, i, it->t->idx(), it->li));
+			const std::vector<face_vertex> &fl = v.faces();
+			for (std::vector<face_vertex>::const_iterator it = fl.begin(); it != fl.end(); ++it)
+				if (&it->f->p(it->li) != &v)
+					sink.add(check_error(check_error::VERTEX_FACE_LIST, i, it->f->idx(), it->li));
+			tet_cnt += tl.size();
+			face_cnt += fl.size();
+		}
+
+#ifdef USE_OPENMP
+#	pragma omp critical
+#endif
 		{
-			cnt++;
-			const face *f = it->f;
-			check = &f->p(it->li) == &_vertices[i];
-			if (!check) {
-				wrong = i;
-				faceno = f->idx();
-				vertno = it->li;
-				ret = false;
-			}
+			report.total += sink.total;
+			report.errors.insert(report.errors.end(), sink.errors.begin(), sink.errors.end());
 		}
 	}
-	return ret;
+
+	std::vector<check_error>::iterator first = report.errors.begin() + (bad_domain ? 1 : 0);
+	std::stable_sort(first, report.errors.end(), check_error_less());
+	if (static_cast<index>(report.errors.end() - first) > max_errors)
+		report.errors.erase(first + max_errors, report.errors.end());
+
+	if (bad_domain)
+		report.total++;
+	if (tet_cnt != 4 * nT) {
+		report.errors.push_back(check_error(check_error::TET_LIST_SIZE, tet_cnt, 4 * nT));
+		report.total++;
+	}
+	if (face_cnt != 3 * nF) {
+		report.errors.push_back(check_error(check_error::FACE_LIST_SIZE, face_cnt, 3 * nF));
+		report.total++;
+	}
+
+	return report;
 }
 
 const ptr_vector<vertex> &mesh::vertices() const {
@@ -8,6 +8,9 @@
 #include "tetrahedron.h"
 
 #include "simple_mesh.h"
+#include "check_report.h"
+#include "alias_table.h"
+#include "field_registry.h"
 
 #ifdef USE_METIS
 # include "mesh_graph.h"
@@ -15,6 +18,9 @@
 
 #include <vector>
 #include <ostream>
+#if __cplusplus >= 201103L
+# include <memory>
+#endif
 
 namespace mesh3d {
 
@@ -22,30 +28,39 @@ class mesh {
 	ptr_vector<vertex> _vertices;
 	ptr_vector<face> _faces;
 	ptr_vector<tetrahedron> _tets;
+	alias_table _aliases;
+	field_registry _fields;
 	index _domain;
 	index _domains;
-	bool checkVertexIndices(index &wrong) const;
-	bool checkTetIndices(index &wrong) const;
-	bool checkFaceIndices(index &wrong) const;
-	bool checkFlippedFace(index &wrong) const;
-	bool checkFlippedOrient(index &wrong) const;
-	bool checkFaceSurface(index &wrong) const;
-	bool checkTetVolume(index &wrong) const;
-	bool checkTetFaceNormals(index &wrong, int &faceno) const;
-	bool checkVertexFaceList(index &wrong, index &faceno, int &vertno, index &cnt) const;
-	bool checkVertexTetList(index &wrong, index &tetno, int &vertno, index &cnt) const;
-	void log(std::ostream *o, const std::string &msg) const;
+	bool _geometry;
 	mesh(const mesh &);
 	mesh &operator=(const mesh &);
+	template <class S>
+	void build(const S &src, bool geometry);
 public:
-	/** Construct mesh from simple mesh */
-	mesh(const simple_mesh &sm, index dom = 0, index domains = 1);
+	/** Construct mesh from simple mesh
+	*
+	* Every constructor computes element geometry (normals, centers, surfaces and volumes) 
+	* only if geometry is true. Otherwise it is left zero until update_geometry is called, 
+	* which saves time for topology-only work like partitioning or format conversion.
+	* An array_mesh is read directly from its arrays instead of through virtual calls */
+	mesh(const simple_mesh &sm, index dom = 0, index domains = 1, bool geometry = true);
 #ifdef USE_METIS
 	/** Construct mesh in domain from global mesh and tet_graph  */
-	mesh(const mesh &sm, index dom, const tet_graph &tg);
+	mesh(const mesh &sm, index dom, const tet_graph &tg, bool geometry = true);
 #endif
 	/** Construct from binary stream */
-	mesh(std::istream &i);
+	mesh(std::istream &i, bool geometry = true);
+#if __cplusplus >= 201103L
+	/** Move construct mesh in constant time, other is left empty
+	*
+	* Elements are not moved in memory, so references to them stay valid */
+	mesh(mesh &&other);
+	/** Move assign mesh in constant time, other is left empty */
+	mesh &operator=(mesh &&other);
+#endif
+	/** Exchange contents with other mesh in constant time */
+	void swap(mesh &other);
 	/** Export to binary stream */
 	void serialize(std::ostream &o) const;
 	/** Dump to text stream */
@@ -58,8 +73,27 @@ public:
 	/** Return domain count */
 	index domains() const { return _domains; }
 
-	/** Run various checks on mesh */
+	/** Check if element geometry has been computed */
+	bool has_geometry() const { return _geometry; }
+	/** Compute geometry of every face and tetrahedron, in parallel if built with OpenMP */
+	void update_geometry();
+	/** Move n vertices verts[i] to positions r[i] and recompute geometry of affected elements
+	*
+	* Only faces and tetrahedrons adjacent to moved vertices are updated, in parallel if built
+	* with OpenMP. Vertex indices must be distinct. If mesh has no geometry, only positions are
+	* changed. If inverted is not null, it receives sorted indices of updated tetrahedrons
+	* with nonpositive volume */
+	void move_vertices(index n, const index *verts, const vector *r, std::vector<index> *inverted = 0);
+
+	/** Run various checks on mesh and print found problems to o. 
+	* Geometric checks are skipped if mesh has no geometry */
 	bool check(std::ostream *o = 0) const;
+	/** Run checks of specified level collecting every problem found
+	*
+	* Faces, tetrahedrons and vertices are checked in a single sweep each, in parallel
+	* if built with OpenMP. At most max_errors per-element problems are stored in the report,
+	* the stored ones are the same for any thread count */
+	check_report validate(check_level level = CHECK_FULL, index max_errors = 100) const;
 
 	/** Return mesh vertices as array */
 	const ptr_vector<vertex> &vertices() const;
@@ -79,8 +113,29 @@ public:
 	const tetrahedron &tets(index i) const {
 		return tets()[i];
 	}
+	/** Return aliases of interface vertices in other domains */
+	const alias_table &aliases() const { return _aliases; }
+	/** Return aliases of i-th vertex in other domains, sorted by domain id */
+	alias_list aliases(index i) const { return _aliases.aliases(i); }
+	/** Return fields attached to mesh elements. They are kept by serialize and partitioning */
+	field_registry &fields() { return _fields; }
+	/** Return fields attached to mesh elements */
+	const field_registry &fields() const { return _fields; }
 };
 
+#if __cplusplus >= 201103L
+/** Read-only mesh shared between threads
+*
+* Const members of mesh and its elements never modify them, so a frozen mesh may be read
+* by any number of threads at once without locking. It is destroyed with the last owner */
+typedef std::shared_ptr<const mesh> shared_mesh;
+
+/** Move m into a shared read-only mesh without copying elements */
+inline shared_mesh freeze(mesh &&m) {
+	return std::make_shared<const mesh>(static_cast<mesh &&>(m));
+}
+#endif
+
 }
 
 #endif
@@ -0,0 +1,62 @@
+#include "mesh_adjacency.h"
+#include "mesh.h"
+#include "parallel.h"
+#include <algorithm>
+
+using namespace mesh3d;
+
+mesh_adjacency::mesh_adjacency(const mesh &m) {
+	const index nV = m.vertices().size();
+	const index nT = m.tets().size();
+
+	std::vector<index> verts(4 * nT);
+	_tet_tets.resize(4 * nT);
+	_tet_flips.resize(4 * nT);
+#ifdef USE_OPENMP
+#	pragma omp parallel for num_threads(mesh3d::num_threads())
+#endif
+	for (index i = 0; i < nT; i++) {
+		const tetrahedron &tet = m.tets(i);
+		for (int j = 0; j < 4; j++) {
+			const face &g = tet.f(j).flip();
+			verts[4 * i + j] = tet.p(j).idx();
+			_tet_flips[4 * i + j] = g.idx();
+			_tet_tets[4 * i + j] = g.is_border() ? BAD_INDEX : g.tet().idx();
+		}
+	}
+	_vertex_tets.transpose(verts.empty() ? 0 : &verts[0], nT, 4, nV);
+
+	/* Neighbours of a vertex are collected from its tetrahedrons, counted first, then filled */
+	std::vector<index> &ptr = _vertex_vertices.ptr();
+	ptr.assign(nV + 1, 0);
+	for (int pass = 0; pass < 2; pass++) {
+		if (pass == 1) {
+			for (index i = 0; i < nV; i++)
+				ptr[i + 1] += ptr[i];
+			_vertex_vertices.idx().resize(ptr[nV]);
+		}
+#ifdef USE_OPENMP
+#	pragma omp parallel num_threads(mesh3d::num_threads())
+#endif
+		{
+			std::vector<index> nb;
+#ifdef USE_OPENMP
+#	pragma omp for schedule(dynamic, 256)
+#endif
+			for (index i = 0; i < nV; i++) {
+				nb.clear();
+				const index *vt = _vertex_tets.row(i);
+				for (index k = 0; k < _vertex_tets.size(i); k++)
+					for (int j = 0; j < 4; j++)
+						if (verts[4 * vt[k] + j] != i)
+							nb.push_back(verts[4 * vt[k] + j]);
+				std::sort(nb.begin(), nb.end());
+				nb.erase(std::unique(nb.begin(), nb.end()), nb.end());
+				if (pass == 0)
+					ptr[i + 1] = nb.size();
+				else
+					std::copy(nb.begin(), nb.end(), _vertex_vertices.idx().begin() + ptr[i]);
+			}
+		}
+	}
+}
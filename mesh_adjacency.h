@@ -0,0 +1,42 @@
+#ifndef __MESH3D__MESH_ADJACENCY_H__
+#define __MESH3D__MESH_ADJACENCY_H__
+
+#include "common.h"
+#include "csr.h"
+
+#include <vector>
+
+namespace mesh3d {
+
+class mesh;
+
+/** Contiguous neighbour tables of a mesh for solver kernels
+*
+* Vertex neighbour lists are stored as CSR tables sorted by index. Tetrahedron
+* neighbours have fixed arity: j-th entry is the tetrahedron across j-th face.
+* Tables are built once and do not follow later changes of the mesh. */
+class mesh_adjacency {
+	csr _vertex_vertices;
+	csr _vertex_tets;
+	std::vector<index> _tet_tets;
+	std::vector<index> _tet_flips;
+public:
+	/** Build adjacency tables of mesh m, in parallel if built with OpenMP */
+	mesh_adjacency(const mesh &m);
+
+	/** Return vertices sharing an edge with every vertex, excluding the vertex itself */
+	const csr &vertex_vertices() const { return _vertex_vertices; }
+	/** Return tetrahedrons containing every vertex */
+	const csr &vertex_tets() const { return _vertex_tets; }
+	/** Return four neighbours of tetrahedron t, BAD_INDEX for border faces */
+	const index *tet_tets(index t) const { return &_tet_tets[4 * t]; }
+	/** Return four faces flipped to faces of tetrahedron t, in mesh face numbering
+	*
+	* For inner faces the entry is 4 * neighbour + face slot in the neighbour,
+	* for border faces it is the border face index */
+	const index *tet_flips(index t) const { return &_tet_flips[4 * t]; }
+};
+
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include "mesh_graph.h"
 #include "mesh.h"
+#include "instrument.h"
 
 using namespace mesh3d;
 
@@ -18,6 +19,7 @@ nodal_graph::nodal_graph(const mesh &m) : graph(m.vertices().size()) {
 }
 
 tet_graph::tet_graph(const mesh &m) : graph(m.tets().size()), m(m) {
+	MESH3D_TIMED_SCOPE("tet_graph::build");
 	for (index i = 0; i < m.tets().size(); i++) {
 		const tetrahedron &tet = m.tets(i);
 		for (int j = 0; j < 4; j++) {
@@ -31,9 +33,13 @@ tet_graph::tet_graph(const mesh &m) : graph(m.tets().size()), m(m) {
 }
 
 bool tet_graph::partition(index num_parts) {
+	MESH3D_TIMED_SCOPE("tet_graph::partition");
 	subvert.clear();
-	if (!graph::partition(num_parts))
-		return false;
+	{
+		MESH3D_TIMED_SCOPE("tet_graph::partition.metis");
+		if (!graph::partition(num_parts))
+			return false;
+	}
 	subvert.resize(num_parts);
 	for (index i = 0; i < m.tets().size(); i++) {
 		index dom = colors(i);
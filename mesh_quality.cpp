@@ -0,0 +1,197 @@
+#include "mesh_quality.h"
+#include "mesh.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace mesh3d;
+
+namespace mesh3d {
+
+namespace {
+
+/** Local vertex indices of tetrahedron faces, in the same order as tetrahedron class uses */
+const int tet_face_verts[4][3] = {{1, 2, 3}, {0, 3, 2}, {0, 1, 3}, {0, 2, 1}};
+
+/** Thread local summary of a measure over its finite values */
+struct summary {
+	double min, max, sum;
+	index min_tet, max_tet;
+	index count, nonfinite;
+	summary() : min(0), max(0), sum(0), min_tet(BAD_INDEX), max_tet(BAD_INDEX), count(0), nonfinite(0) { }
+	void add(double v, index i) {
+		if (!std::isfinite(v)) {
+			nonfinite++;
+			return;
+		}
+		count++;
+		if (min_tet == BAD_INDEX || v < min) {
+			min = v;
+			min_tet = i;
+		}
+		if (max_tet == BAD_INDEX || v > max) {
+			max = v;
+			max_tet = i;
+		}
+		sum += v;
+	}
+	/* Ties are resolved to the lowest index, so the result does not depend on thread count */
+	void merge(const summary &o) {
+		nonfinite += o.nonfinite;
+		if (o.min_tet == BAD_INDEX)
+			return;
+		count += o.count;
+		if (min_tet == BAD_INDEX || o.min < min || (o.min == min && o.min_tet < min_tet)) {
+			min = o.min;
+			min_tet = o.min_tet;
+		}
+		if (max_tet == BAD_INDEX || o.max > max || (o.max == max && o.max_tet < max_tet)) {
+			max = o.max;
+			max_tet = o.max_tet;
+		}
+		sum += o.sum;
+	}
+};
+
+}
+
+}
+
+void mesh_quality::tet_measures(const vector *p, double *q) {
+	const double rad2deg = 180 / std::acos(-1.);
+
+	double lmin = 0, lmax = 0;
+	for (int i = 0; i < 4; i++)
+		for (int j = i + 1; j < 4; j++) {
+			double l = norm(p[j] - p[i]);
+			if ((i == 0 && j == 1) || l < lmin)
+				lmin = l;
+			if (l > lmax)
+				lmax = l;
+		}
+
+	const vector a = p[1] - p[0], b = p[2] - p[0], c = p[3] - p[0];
+	/* Same sign as tetrahedron::volume */
+	const double vol = 1. / 6 * (p[2] - p[3]).dot((p[0] - p[3]) % (p[1] - p[3]));
+
+	/* Outward face normals with lengths of doubled face surfaces */
+	vector n[4];
+	double s[4], stot = 0, smax = 0;
+	for (int k = 0; k < 4; k++) {
+		const vector &o = p[tet_face_verts[k][0]];
+		n[k] = (p[tet_face_verts[k][1]] - o) % (p[tet_face_verts[k][2]] - o);
+		if (n[k].dot(p[k] - o) > 0)
+			n[k] = -n[k];
+		s[k] = 0.5 * norm(n[k]);
+		stot += s[k];
+		smax = std::max(smax, s[k]);
+	}
+
+	const double rin = 3 * vol / stot;
+	const double rcirc = norm(a.dot(a) * (b % c) + b.dot(b) * (c % a) + c.dot(c) * (a % b)) / (12 * std::fabs(vol));
+
+	q[ASPECT_RATIO] = lmax / (2 * std::sqrt(6.) * rin);
+	q[RADIUS_RATIO] = 3 * rin / rcirc;
+
+	double dmin = 180, dmax = 0;
+	for (int i = 0; i < 4; i++)
+		for (int j = i + 1; j < 4; j++) {
+			double cosv = n[i].dot(n[j]) / (4 * s[i] * s[j]);
+			cosv = std::max(-1., std::min(1., cosv));
+			double d = 180 - rad2deg * std::acos(cosv);
+			dmin = std::min(dmin, d);
+			dmax = std::max(dmax, d);
+		}
+	q[MIN_DIHEDRAL] = dmin;
+	q[MAX_DIHEDRAL] = dmax;
+
+	q[MIN_EDGE] = lmin;
+	q[MAX_EDGE] = lmax;
+	q[MIN_HEIGHT] = 3 * std::fabs(vol) / smax;
+}
+
+const char *mesh_quality::name(quality_measure q) {
+	switch (q) {
+		case ASPECT_RATIO: return "aspect_ratio";
+		case RADIUS_RATIO: return "radius_ratio";
+		case MIN_DIHEDRAL: return "min_dihedral";
+		case MAX_DIHEDRAL: return "max_dihedral";
+		case MIN_EDGE: return "min_edge";
+		case MAX_EDGE: return "max_edge";
+		case MIN_HEIGHT: return "min_height";
+		default: return "";
+	}
+}
+
+mesh_quality::mesh_quality(const mesh &m, index bins) {
+	const index nT = m.tets().size();
+	const int nQ = NUM_QUALITY_MEASURES;
+	bins = std::max<index>(bins, 1);
+
+	for (int k = 0; k < nQ; k++)
+		_values[k].resize(nT);
+	summary total[NUM_QUALITY_MEASURES];
+
+#ifdef USE_OPENMP
+#	pragma omp parallel num_threads(mesh3d::num_threads())
+#endif
+	{
+		summary local[NUM_QUALITY_MEASURES];
+#ifdef USE_OPENMP
+#	pragma omp for schedule(static)
+#endif
+		for (index i = 0; i < nT; i++) {
+			vector p[4];
+			double q[NUM_QUALITY_MEASURES];
+			for (int j = 0; j < 4; j++)
+				p[j] = m.tets(i).p(j).r();
+			tet_measures(p, q);
+			for (int k = 0; k < nQ; k++) {
+				_values[k][i] = q[k];
+				local[k].add(q[k], i);
+			}
+		}
+#ifdef USE_OPENMP
+#	pragma omp critical
+#endif
+		for (int k = 0; k < nQ; k++)
+			total[k].merge(local[k]);
+	}
+
+	for (int k = 0; k < nQ; k++) {
+		quality_histogram &h = _hist[k];
+		h.min = total[k].min;
+		h.max = total[k].max;
+		h.min_tet = total[k].min_tet;
+		h.max_tet = total[k].max_tet;
+		h.nonfinite = total[k].nonfinite;
+		h.mean = total[k].count ? total[k].sum / total[k].count : 0;
+		h.counts.assign(bins, 0);
+	}
+
+#ifdef USE_OPENMP
+#	pragma omp parallel num_threads(mesh3d::num_threads())
+#endif
+	{
+		std::vector<index> local(nQ * bins, 0);
+#ifdef USE_OPENMP
+#	pragma omp for schedule(static)
+#endif
+		for (index i = 0; i < nT; i++)
+			for (int k = 0; k < nQ; k++) {
+				const quality_histogram &h = _hist[k];
+				if (!std::isfinite(_values[k][i]))
+					continue;
+				index b = 0;
+				if (h.max > h.min)
+					b = std::min(static_cast<index>((_values[k][i] - h.min) / (h.max - h.min) * bins), bins - 1);
+				local[k * bins + b]++;
+			}
+#ifdef USE_OPENMP
+#	pragma omp critical
+#endif
+		for (int k = 0; k < nQ; k++)
+			for (index b = 0; b < bins; b++)
+				_hist[k].counts[b] += local[k * bins + b];
+	}
+}
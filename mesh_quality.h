@@ -0,0 +1,80 @@
+#ifndef __MESH3D__MESH_QUALITY_H__
+#define __MESH3D__MESH_QUALITY_H__
+
+#include "common.h"
+#include "vector.h"
+
+#include <vector>
+
+namespace mesh3d {
+
+class mesh;
+
+/** Tetrahedron quality measures computed by mesh_quality */
+enum quality_measure {
+	/** Longest edge over inradius, scaled to be 1 for regular tetrahedron */
+	ASPECT_RATIO,
+	/** Three inradii over circumradius, 1 for regular tetrahedron and 0 for degenerate one */
+	RADIUS_RATIO,
+	/** Minimal dihedral angle in degrees */
+	MIN_DIHEDRAL,
+	/** Maximal dihedral angle in degrees */
+	MAX_DIHEDRAL,
+	/** Shortest edge length */
+	MIN_EDGE,
+	/** Longest edge length */
+	MAX_EDGE,
+	/** Minimal height, three volumes over largest face surface. Used as CFL length scale */
+	MIN_HEIGHT,
+	/** Number of measures */
+	NUM_QUALITY_MEASURES
+};
+
+/** Summary and histogram of a quality measure over all tetrahedrons
+*
+* Infinite and NaN values, which degenerate tetrahedrons may have, are only counted
+* in nonfinite. The summary and the bins cover finite values */
+struct quality_histogram {
+	double min; //!< minimal value
+	double max; //!< maximal value
+	double mean; //!< mean value
+	index min_tet; //!< tetrahedron with minimal value
+	index max_tet; //!< tetrahedron with maximal value
+	index nonfinite; //!< number of infinite or NaN values
+	/** Number of values in equal bins covering [min, max] */
+	std::vector<index> counts;
+
+	/** Return lower bound of i-th bin */
+	double bin_lo(index i) const { return min + (max - min) * i / counts.size(); }
+	/** Return upper bound of i-th bin */
+	double bin_hi(index i) const { return min + (max - min) * (i + 1) / counts.size(); }
+};
+
+/** A class computing quality of every tetrahedron in a mesh
+*
+* Measures are computed from vertex positions in parallel if built with OpenMP, so
+* mesh geometry is not required. Inverted tetrahedrons get negative aspect and radius ratios.
+* Per-element arrays are suitable for vtk_stream::append_cell_data. */
+class mesh_quality {
+	std::vector<double> _values[NUM_QUALITY_MEASURES];
+	quality_histogram _hist[NUM_QUALITY_MEASURES];
+public:
+	/** Compute quality measures of mesh m and histograms with given number of bins */
+	mesh_quality(const mesh &m, index bins = 20);
+
+	/** Return values of a measure for every tetrahedron */
+	const std::vector<double> &values(quality_measure q) const { return _values[q]; }
+	/** Return summary and histogram of a measure */
+	const quality_histogram &histogram(quality_measure q) const { return _hist[q]; }
+	/** Return minimal length scale over the mesh for CFL time step estimation */
+	double min_length_scale() const { return _hist[MIN_HEIGHT].min; }
+
+	/** Compute every quality measure of a tetrahedron with vertices p, result has NUM_QUALITY_MEASURES values */
+	static void tet_measures(const vector *p, double *q);
+	/** Return measure name, suitable for vtk array name */
+	static const char *name(quality_measure q);
+};
+
+}
+
+#endif
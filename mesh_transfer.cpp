@@ -0,0 +1,395 @@
+#include "mesh_transfer.h"
+#include "mesh.h"
+#include "parallel.h"
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+using namespace mesh3d;
+
+namespace mesh3d {
+
+namespace {
+
+typedef std::vector<std::pair<index, double> > weight_list;
+
+/** Small open addressing set of indices, its size follows the number of inserted entries
+*
+* Used as the visited set of a flood, so memory and clearing time are proportional to
+* the flood size rather than to the source mesh size */
+class index_set {
+	std::vector<index> slots;
+	std::vector<index> used;
+
+	index find_slot(index x) const {
+		const uint64_t h = static_cast<uint64_t>(x) * 0x9e3779b97f4a7c15ull;
+		const index mask = slots.size() - 1;
+		index s = static_cast<index>(h >> 32) & mask;
+		while (slots[s] != BAD_INDEX && slots[s] != x)
+			s = (s + 1) & mask;
+		return s;
+	}
+	void grow() {
+		std::vector<index> values;
+		for (size_t k = 0; k < used.size(); k++)
+			values.push_back(slots[used[k]]);
+		slots.assign(std::max<size_t>(2 * slots.size(), 64), BAD_INDEX);
+		used.clear();
+		for (size_t k = 0; k < values.size(); k++)
+			insert(values[k]);
+	}
+public:
+	/** Remove every entry in time proportional to their number */
+	void clear() {
+		for (size_t k = 0; k < used.size(); k++)
+			slots[used[k]] = BAD_INDEX;
+		used.clear();
+	}
+	/** Insert x, return false if it is already present */
+	bool insert(index x) {
+		if (2 * (used.size() + 1) > slots.size())
+			grow();
+		const index s = find_slot(x);
+		if (slots[s] == x)
+			return false;
+		slots[s] = x;
+		used.push_back(s);
+		return true;
+	}
+};
+
+/** Local vertex indices of tetrahedron faces, in the same order as tetrahedron class uses */
+const int tet_face_verts[4][3] = {{1, 2, 3}, {0, 3, 2}, {0, 1, 3}, {0, 2, 1}};
+
+/* Tetrahedron clipped by four planes has at most eight faces. Every face has at most
+   seven vertices, and a cap gets at most two points from every other face */
+const int MAX_FACES = 8;
+const int MAX_VERTS = 2 * MAX_FACES;
+
+/** Convex polyhedron stored as a list of faces */
+struct polyhedron {
+	int nf;
+	int nv[MAX_FACES];
+	vector v[MAX_FACES][MAX_VERTS];
+};
+
+/** Clip convex polyhedron in keeping the part where n.(x - o) >= 0
+*
+* Points closer than tol to the plane are considered lying on it, so faces coplanar
+* with the plane are kept as is */
+void clip(const polyhedron &in, polyhedron &out, const vector &n, const vector &o, double tol) {
+	vector cut[MAX_VERTS];
+	int nc = 0;
+	double d[MAX_VERTS];
+	out.nf = 0;
+	for (int f = 0; f < in.nf; f++) {
+		const int m = in.nv[f];
+		const vector *poly = in.v[f];
+		bool outside = false;
+		for (int e = 0; e < m; e++) {
+			d[e] = n.dot(poly[e] - o);
+			if (std::fabs(d[e]) <= tol)
+				d[e] = 0;
+			outside |= d[e] < 0;
+		}
+		vector *res = out.v[out.nf];
+		int k = 0;
+		for (int e = 0; e < m; e++) {
+			const vector &p = poly[e];
+			const double dp = d[e];
+			if (dp >= 0)
+				res[k++] = p;
+			if (!outside)
+				continue;
+			const vector &q = poly[(e + 1) % m];
+			const double dq = d[(e + 1) % m];
+			if (dp == 0 && nc < MAX_VERTS)
+				cut[nc++] = p;
+			if ((dp > 0 && dq < 0) || (dp < 0 && dq > 0)) {
+				vector x = p + (q - p) * (dp / (dp - dq));
+				res[k++] = x;
+				if (nc < MAX_VERTS)
+					cut[nc++] = x;
+			}
+		}
+		if (k >= 3)
+			out.nv[out.nf++] = k;
+	}
+
+	/* Close the polyhedron with a cap made of cut points sorted by angle around the normal */
+	if (nc >= 3 && out.nf < MAX_FACES) {
+		vector c;
+		for (int i = 0; i < nc; i++)
+			c += cut[i];
+		c *= 1.0 / nc;
+		vector u;
+		for (int i = 0; i < nc && norm(u) == 0; i++)
+			u = cut[i] - c;
+		const vector w = n % u;
+		std::pair<double, int> angles[MAX_VERTS];
+		for (int i = 0; i < nc; i++) {
+			const vector d = cut[i] - c;
+			angles[i] = std::make_pair(std::atan2(d.dot(w), d.dot(u)), i);
+		}
+		std::sort(angles, angles + nc);
+		/* Every cut point is shared by two faces, keep one copy */
+		vector *cap = out.v[out.nf];
+		int k = 0;
+		for (int i = 0; i < nc; i++) {
+			const vector &p = cut[angles[i].second];
+			if (k == 0 || norm(p - cap[k - 1]) > tol / norm(n))
+				cap[k++] = p;
+		}
+		if (k >= 3)
+			out.nv[out.nf++] = k;
+	}
+}
+
+double tet_volume(const vector *p) {
+	return std::fabs((p[0] - p[3]).dot((p[1] - p[3]) % (p[2] - p[3]))) / 6;
+}
+
+void tet_points(const mesh &m, index t, vector *p) {
+	for (int j = 0; j < 4; j++)
+		p[j] = m.tets(t).p(j).r();
+}
+
+/** Check if b lies on the outer side of one of the a faces. Returns true if b is inside a */
+bool separated(const vector *a, const vector *b, bool &inside) {
+	inside = true;
+	for (int k = 0; k < 4; k++) {
+		const vector &o = a[tet_face_verts[k][0]];
+		vector n = (a[tet_face_verts[k][1]] - o) % (a[tet_face_verts[k][2]] - o);
+		if (n.dot(a[k] - o) < 0)
+			n = -n;
+		int below = 0;
+		for (int j = 0; j < 4; j++) {
+			const double d = n.dot(b[j] - o);
+			below += d <= 0;
+			inside &= d >= 0;
+		}
+		if (below == 4)
+			return true;
+	}
+	return false;
+}
+
+bool boxes_overlap(const vector *a, const vector *b) {
+	vector alo(a[0]), ahi(a[0]), blo(b[0]), bhi(b[0]);
+	for (int j = 1; j < 4; j++) {
+		alo = vector(std::min(alo.x, a[j].x), std::min(alo.y, a[j].y), std::min(alo.z, a[j].z));
+		ahi = vector(std::max(ahi.x, a[j].x), std::max(ahi.y, a[j].y), std::max(ahi.z, a[j].z));
+		blo = vector(std::min(blo.x, b[j].x), std::min(blo.y, b[j].y), std::min(blo.z, b[j].z));
+		bhi = vector(std::max(bhi.x, b[j].x), std::max(bhi.y, b[j].y), std::max(bhi.z, b[j].z));
+	}
+	return alo.x <= bhi.x && blo.x <= ahi.x &&
+		alo.y <= bhi.y && blo.y <= ahi.y &&
+		alo.z <= bhi.z && blo.z <= ahi.z;
+}
+
+}
+
+}
+
+double mesh_transfer::overlap_volume(const vector *a, const vector *b) {
+	bool a_in_b, b_in_a;
+	if (!boxes_overlap(a, b) || separated(a, b, b_in_a) || separated(b, a, a_in_b))
+		return 0;
+	if (b_in_a)
+		return tet_volume(b);
+	if (a_in_b)
+		return tet_volume(a);
+
+	polyhedron buf[2];
+	polyhedron *cur = &buf[0], *next = &buf[1];
+	cur->nf = 4;
+	for (int k = 0; k < 4; k++) {
+		cur->nv[k] = 3;
+		for (int j = 0; j < 3; j++)
+			cur->v[k][j] = b[tet_face_verts[k][j]];
+	}
+
+	for (int k = 0; k < 4 && cur->nf > 0; k++) {
+		const vector &o = a[tet_face_verts[k][0]];
+		vector n = (a[tet_face_verts[k][1]] - o) % (a[tet_face_verts[k][2]] - o);
+		if (n.dot(a[k] - o) < 0)
+			n = -n;
+		const double nn = norm(n);
+		clip(*cur, *next, n, o, 1e-12 * nn * std::sqrt(nn));
+		std::swap(cur, next);
+	}
+
+	if (cur->nf == 0)
+		return 0;
+
+	/* Sum pyramids from an inner point, face orientation does not matter */
+	vector g;
+	int cnt = 0;
+	for (int i = 0; i < cur->nf; i++)
+		for (int j = 0; j < cur->nv[i]; j++, cnt++)
+			g += cur->v[i][j];
+	g *= 1.0 / cnt;
+
+	double vol = 0;
+	for (int i = 0; i < cur->nf; i++) {
+		const vector *f = cur->v[i];
+		for (int j = 1; j + 1 < cur->nv[i]; j++)
+			vol += std::fabs((f[0] - g).dot((f[j] - g) % (f[j + 1] - g)));
+	}
+	return vol / 6;
+}
+
+mesh_transfer::mesh_transfer(const mesh &src, const mesh &dst, cell_transfer_mode mode)
+	: src(src), dst(dst), loc(src)
+{
+	map_vertices();
+	map_cells(mode);
+}
+
+void mesh_transfer::map_vertices() {
+	const index nV = dst.vertices().size();
+	vert_src.assign(4 * nV, BAD_INDEX);
+	vert_w.assign(4 * nV, 0);
+	index unmapped = 0;
+
+#ifdef USE_OPENMP
+#	pragma omp parallel reduction(+:unmapped) num_threads(mesh3d::num_threads())
+#endif
+	{
+		/* Consecutive vertices are usually close, so the previous result is a good guess */
+		index guess = BAD_INDEX;
+#ifdef USE_OPENMP
+#	pragma omp for schedule(static)
+#endif
+		for (index i = 0; i < nV; i++) {
+			double b[4];
+			index t = loc.locate_from(dst.vertices(i).r(), guess, b);
+			if (t == BAD_INDEX) {
+				unmapped++;
+				continue;
+			}
+			guess = t;
+			for (int j = 0; j < 4; j++) {
+				vert_src[4 * i + j] = src.tets(t).p(j).idx();
+				vert_w[4 * i + j] = b[j];
+			}
+		}
+	}
+	_unmapped_vertices = unmapped;
+}
+
+void mesh_transfer::map_cells(cell_transfer_mode mode) {
+	const index nT = dst.tets().size();
+	std::vector<weight_list> lists(nT);
+	index unmapped = 0;
+
+#ifdef USE_OPENMP
+#	pragma omp parallel reduction(+:unmapped) num_threads(mesh3d::num_threads())
+#endif
+	{
+		index guess = BAD_INDEX;
+		std::vector<index> front;
+		index_set visited;
+#ifdef USE_OPENMP
+#	pragma omp for schedule(dynamic, 64)
+#endif
+		for (index i = 0; i < nT; i++) {
+			vector p[4], c;
+			tet_points(dst, i, p);
+			for (int j = 0; j < 4; j++)
+				c += p[j];
+			c *= 0.25;
+
+			index seed = loc.locate_from(c, guess);
+			for (int j = 0; j < 4 && seed == BAD_INDEX && mode == CELL_CONSERVATIVE; j++)
+				seed = loc.locate_from(p[j], guess);
+			if (seed == BAD_INDEX) {
+				unmapped++;
+				continue;
+			}
+			guess = seed;
+
+			if (mode == CELL_NEAREST) {
+				lists[i].push_back(std::make_pair(seed, 1.0));
+				continue;
+			}
+
+			/* Flood overlapping source tetrahedrons through their faces starting from seed */
+			const double tol = 1e-12 * tet_volume(p);
+			visited.clear();
+			visited.insert(seed);
+			front.assign(1, seed);
+			while (!front.empty()) {
+				const index s = front.back();
+				front.pop_back();
+				vector q[4];
+				tet_points(src, s, q);
+				const double v = overlap_volume(q, p);
+				if (v > tol)
+					lists[i].push_back(std::make_pair(s, v));
+				else if (s != seed)
+					continue;
+				for (int k = 0; k < 4; k++) {
+					const face &f = src.tets(s).f(k).flip();
+					if (f.is_border())
+						continue;
+					const index n = f.tet().idx();
+					if (visited.insert(n))
+						front.push_back(n);
+				}
+			}
+			if (lists[i].empty())
+				unmapped++;
+		}
+	}
+	_unmapped_cells = unmapped;
+
+	cell_ptr.resize(nT + 1);
+	cell_ptr[0] = 0;
+	for (index i = 0; i < nT; i++)
+		cell_ptr[i + 1] = cell_ptr[i] + lists[i].size();
+	cell_src.resize(cell_ptr[nT]);
+	cell_w.resize(cell_ptr[nT]);
+	for (index i = 0; i < nT; i++)
+		for (index k = 0; k < lists[i].size(); k++) {
+			cell_src[cell_ptr[i] + k] = lists[i][k].first;
+			cell_w[cell_ptr[i] + k] = lists[i][k].second;
+		}
+}
+
+void mesh_transfer::vertex_data(const double *in, double *out, int ncomp) const {
+	const index nV = dst.vertices().size();
+#ifdef USE_OPENMP
+#	pragma omp parallel for schedule(static) num_threads(mesh3d::num_threads())
+#endif
+	for (index i = 0; i < nV; i++) {
+		if (vert_src[4 * i] == BAD_INDEX)
+			continue;
+		for (int c = 0; c < ncomp; c++) {
+			double s = 0;
+			for (int j = 0; j < 4; j++)
+				s += vert_w[4 * i + j] * in[vert_src[4 * i + j] * ncomp + c];
+			out[i * ncomp + c] = s;
+		}
+	}
+}
+
+void mesh_transfer::cell_data(const double *in, double *out, int ncomp) const {
+	const index nT = dst.tets().size();
+#ifdef USE_OPENMP
+#	pragma omp parallel for schedule(static) num_threads(mesh3d::num_threads())
+#endif
+	for (index i = 0; i < nT; i++) {
+		if (cell_ptr[i] == cell_ptr[i + 1])
+			continue;
+		double w = 0;
+		for (index k = cell_ptr[i]; k < cell_ptr[i + 1]; k++)
+			w += cell_w[k];
+		for (int c = 0; c < ncomp; c++) {
+			double s = 0;
+			for (index k = cell_ptr[i]; k < cell_ptr[i + 1]; k++)
+				s += cell_w[k] * in[cell_src[k] * ncomp + c];
+			out[i * ncomp + c] = s / w;
+		}
+	}
+}
@@ -0,0 +1,70 @@
+#ifndef __MESH3D__MESH_TRANSFER_H__
+#define __MESH3D__MESH_TRANSFER_H__
+
+#include "common.h"
+#include "tet_locator.h"
+
+#include <vector>
+
+namespace mesh3d {
+
+class mesh;
+
+/** Method of cell data transfer */
+enum cell_transfer_mode {
+	/** Take the value of source tetrahedron containing target tetrahedron center */
+	CELL_NEAREST,
+	/** Average source values weighted by exact overlap volumes of source and target tetrahedrons */
+	CELL_CONSERVATIVE
+};
+
+/** A class for transferring vertex and cell fields from one mesh to another
+*
+* Interpolation weights are computed once on construction, in parallel if built with OpenMP.
+* Vertex data is interpolated linearly using barycentric coordinates of target vertices
+* in source tetrahedrons. Conservative cell weights are normalized by the total overlap volume,
+* which equals target tetrahedron volume if it lies inside the source mesh.
+* Target vertices and tetrahedrons outside of the source mesh are left unmapped
+* and their output values are not changed. */
+class mesh_transfer {
+	const mesh &src;
+	const mesh &dst;
+	tet_locator loc;
+
+	/* Source vertices and weights for every target vertex */
+	std::vector<index> vert_src;
+	std::vector<double> vert_w;
+	index _unmapped_vertices;
+
+	/* Sources and weights for every target tetrahedron in CSR layout */
+	std::vector<index> cell_ptr;
+	std::vector<index> cell_src;
+	std::vector<double> cell_w;
+	index _unmapped_cells;
+
+	void map_vertices();
+	void map_cells(cell_transfer_mode mode);
+
+	mesh_transfer(const mesh_transfer &);
+	mesh_transfer &operator=(const mesh_transfer &);
+public:
+	/** Prepare transfer from src to dst meshes. Both meshes should outlive the object */
+	mesh_transfer(const mesh &src, const mesh &dst, cell_transfer_mode mode = CELL_CONSERVATIVE);
+
+	/** Transfer vertex field with ncomp interleaved components per vertex */
+	void vertex_data(const double *in, double *out, int ncomp = 1) const;
+	/** Transfer cell field with ncomp interleaved components per tetrahedron */
+	void cell_data(const double *in, double *out, int ncomp = 1) const;
+
+	/** Return number of target vertices outside of the source mesh */
+	index unmapped_vertices() const { return _unmapped_vertices; }
+	/** Return number of target tetrahedrons not overlapping the source mesh */
+	index unmapped_cells() const { return _unmapped_cells; }
+
+	/** Compute volume of intersection of two tetrahedrons given by their vertices */
+	static double overlap_volume(const vector *a, const vector *b);
+};
+
+}
+
+#endif
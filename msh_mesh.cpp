@@ -0,0 +1,485 @@
+#include "msh_mesh.h"
+#include <stdexcept>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <map>
+#include <stdint.h>
+
+using namespace mesh3d;
+
+namespace mesh3d {
+
+namespace {
+
+/** Number of nodes for msh element types. Zero means unknown type */
+int element_nodes(int type) {
+	static const int nodes[] = {
+		0, 2, 3, 4, 4, 8, 6, 5, 3, 6, 9, 10, 27, 18, 14, 1, 8, 20, 15, 13,
+		9, 10, 12, 15, 15, 21, 4, 5, 6, 20, 35, 56
+	};
+	if (type < 0 || type >= static_cast<int>(sizeof(nodes) / sizeof(nodes[0])))
+		return 0;
+	return nodes[type];
+}
+
+const int MSH_TRIANGLE = 2;
+const int MSH_TETRAHEDRON = 4;
+const int MSH_TRIANGLE6 = 9;
+const int MSH_TETRAHEDRON10 = 11;
+
+/** Cursor over the whole file contents, read in one piece */
+class msh_reader {
+	std::vector<char> buf;
+	const char *p;
+	const char *end;
+	bool bin;
+public:
+	msh_reader(const char *fn) : bin(false) {
+		std::ifstream f(fn, std::ios::in | std::ios::binary);
+		if (!f)
+			throw std::invalid_argument("Could not read file `" + std::string(fn) + "'");
+		f.seekg(0, std::ios::end);
+		std::streamsize size = f.tellg();
+		f.seekg(0, std::ios::beg);
+		buf.resize(static_cast<size_t>(size) + 1);
+		if (size > 0)
+			f.read(&buf[0], size);
+		if (f.gcount() != size)
+			throw std::runtime_error("Could not read file `" + std::string(fn) + "'");
+		buf[size] = 0;
+		p = &buf[0];
+		end = p + size;
+	}
+
+	void set_binary(bool b) { bin = b; }
+	bool binary() const { return bin; }
+	bool eof() {
+		skip_space();
+		return p >= end;
+	}
+
+	void skip_space() {
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+			p++;
+	}
+
+	/** Read a whitespace-delimited word */
+	std::string word() {
+		skip_space();
+		const char *q = p;
+		while (p < end && !(*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+			p++;
+		return std::string(q, p);
+	}
+
+	void skip_line() {
+		while (p < end && *p != '\n')
+			p++;
+		if (p < end)
+			p++;
+	}
+
+	/** Skip everything up to and including the section end marker */
+	void skip_to(const std::string &marker) {
+		while (p < end) {
+			const char *q = static_cast<const char *>(memchr(p, '$', end - p));
+			if (!q)
+				break;
+			p = q;
+			if (static_cast<size_t>(end - p) >= marker.size() && 0 == memcmp(p, marker.data(), marker.size())) {
+				p += marker.size();
+				return;
+			}
+			p++;
+		}
+		throw std::logic_error("Parse msh file failed: `" + marker + "' not found");
+	}
+
+	void expect(const std::string &marker) {
+		std::string w = word();
+		if (w != marker)
+			throw std::logic_error("Parse msh file failed: expected `" + marker + "', got `" + w + "'");
+	}
+
+	void need(size_t bytes) {
+		if (static_cast<size_t>(end - p) < bytes)
+			throw std::logic_error("Parse msh file failed: unexpected end of file");
+	}
+
+	void raw(void *dst, size_t bytes) {
+		need(bytes);
+		memcpy(dst, p, bytes);
+		p += bytes;
+	}
+
+	long long ascii_int() {
+		char *q;
+		long long ret = strtoll(p, &q, 10);
+		if (q == p)
+			throw std::logic_error("Parse msh file failed: integer expected");
+		p = q;
+		return ret;
+	}
+
+	double ascii_double() {
+		char *q;
+		double ret = strtod(p, &q);
+		if (q == p)
+			throw std::logic_error("Parse msh file failed: number expected");
+		p = q;
+		return ret;
+	}
+
+	/** Read int field */
+	long long get_int() {
+		if (!bin)
+			return ascii_int();
+		int32_t v;
+		raw(&v, sizeof(v));
+		return v;
+	}
+
+	/** Read size_t field */
+	uint64_t get_size() {
+		if (!bin)
+			return ascii_int();
+		uint64_t v;
+		raw(&v, sizeof(v));
+		return v;
+	}
+
+	/** Read double field */
+	double get_double() {
+		if (!bin)
+			return ascii_double();
+		double v;
+		raw(&v, sizeof(v));
+		return v;
+	}
+
+	/** Read n size_t fields */
+	void get_sizes(uint64_t *v, size_t n) {
+		if (bin) {
+			raw(v, n * sizeof(uint64_t));
+			return;
+		}
+		for (size_t i = 0; i < n; i++)
+			v[i] = ascii_int();
+	}
+
+	/** Read n double fields */
+	void get_doubles(double *v, size_t n) {
+		if (bin) {
+			raw(v, n * sizeof(double));
+			return;
+		}
+		for (size_t i = 0; i < n; i++)
+			v[i] = ascii_double();
+	}
+};
+
+typedef std::map<std::pair<int, int>, index> physical_map;
+
+void read_format(msh_reader &r) {
+	std::string version = r.word();
+	if (version != "4.1")
+		throw std::domain_error("Msh format version " + version + " not implemented, only 4.1 is supported");
+	int file_type = atoi(r.word().c_str());
+	int data_size = atoi(r.word().c_str());
+	if (data_size != sizeof(uint64_t))
+		throw std::domain_error("Msh data size other than 8 not implemented");
+	if (file_type == 1) {
+		r.skip_line();
+		int32_t one;
+		r.raw(&one, sizeof(one));
+		if (one != 1)
+			throw std::domain_error("Msh files with foreign byte order not implemented");
+		r.set_binary(true);
+	}
+	r.expect("$EndMeshFormat");
+}
+
+void read_entities(msh_reader &r, physical_map &phys) {
+	uint64_t num[4];
+	r.get_sizes(num, 4);
+	for (int dim = 0; dim < 4; dim++) {
+		for (uint64_t i = 0; i < num[dim]; i++) {
+			int tag = r.get_int();
+			double box[6];
+			r.get_doubles(box, dim == 0 ? 3 : 6);
+			uint64_t nphys = r.get_size();
+			for (uint64_t k = 0; k < nphys; k++) {
+				index ptag = r.get_int();
+				if (k == 0)
+					phys[std::make_pair(dim, tag)] = ptag;
+			}
+			if (dim == 0)
+				continue;
+			uint64_t nbnd = r.get_size();
+			for (uint64_t k = 0; k < nbnd; k++)
+				r.get_int();
+		}
+	}
+	r.expect("$EndEntities");
+}
+
+void read_nodes(msh_reader &r, std::vector<double> &vert, std::vector<index> &tag2idx, uint64_t &min_tag) {
+	uint64_t head[4];
+	r.get_sizes(head, 4);
+	uint64_t blocks = head[0];
+	uint64_t n = head[1];
+	min_tag = head[2];
+	uint64_t max_tag = head[3];
+
+	vert.resize(3 * n);
+	tag2idx.assign(n ? max_tag - min_tag + 1 : 0, BAD_INDEX);
+
+	std::vector<uint64_t> tags;
+	std::vector<double> coords;
+	index i = 0;
+	for (uint64_t b = 0; b < blocks; b++) {
+		int dim = r.get_int();
+		r.get_int();
+		int parametric = r.get_int();
+		uint64_t cnt = r.get_size();
+		if (i + cnt > n)
+			throw std::logic_error("Parse msh file failed: too many nodes");
+		tags.resize(cnt);
+		if (cnt)
+			r.get_sizes(&tags[0], cnt);
+		for (uint64_t k = 0; k < cnt; k++) {
+			if (tags[k] < min_tag || tags[k] > max_tag)
+				throw std::logic_error("Parse msh file failed: node tag out of range");
+			tag2idx[tags[k] - min_tag] = i + k;
+		}
+		size_t stride = 3 + (parametric ? dim : 0);
+		if (stride == 3) {
+			if (cnt)
+				r.get_doubles(&vert[3 * i], 3 * cnt);
+		} else {
+			coords.resize(stride * cnt);
+			if (cnt)
+				r.get_doubles(&coords[0], stride * cnt);
+			for (uint64_t k = 0; k < cnt; k++)
+				for (int j = 0; j < 3; j++)
+					vert[3 * (i + k) + j] = coords[stride * k + j];
+		}
+		i += cnt;
+	}
+	if (i != n)
+		throw std::logic_error("Parse msh file failed: node count mismatch");
+	r.expect("$EndNodes");
+}
+
+void read_elements(msh_reader &r, const physical_map &phys,
+	const std::vector<index> &tag2idx, uint64_t min_tag,
+	std::vector<index> &tet, std::vector<index> &tetmat,
+	std::vector<index> &bnd, std::vector<index> &bndmat)
+{
+	uint64_t head[4];
+	r.get_sizes(head, 4);
+	uint64_t blocks = head[0];
+
+	std::vector<uint64_t> data;
+	for (uint64_t b = 0; b < blocks; b++) {
+		int dim = r.get_int();
+		int entity = r.get_int();
+		int type = r.get_int();
+		uint64_t cnt = r.get_size();
+
+		if (type == MSH_TETRAHEDRON10)
+			throw std::domain_error("High-order tetrahedrons not implemented");
+		if (type == MSH_TRIANGLE6)
+			throw std::domain_error("High-order faces not implemented");
+		int np = element_nodes(type);
+		if (np == 0)
+			throw std::domain_error("Unknown msh element type");
+
+		data.resize(cnt * (np + 1));
+		if (!data.empty())
+			r.get_sizes(&data[0], data.size());
+		if (type != MSH_TETRAHEDRON && type != MSH_TRIANGLE)
+			continue;
+
+		physical_map::const_iterator it = phys.find(std::make_pair(dim, entity));
+		index mat = it == phys.end() ? static_cast<index>(entity) : it->second;
+
+		std::vector<index> &conn = type == MSH_TETRAHEDRON ? tet : bnd;
+		std::vector<index> &cmat = type == MSH_TETRAHEDRON ? tetmat : bndmat;
+		for (uint64_t k = 0; k < cnt; k++) {
+			const uint64_t *e = &data[k * (np + 1) + 1];
+			for (int j = 0; j < np; j++) {
+				if (e[j] < min_tag || e[j] - min_tag >= tag2idx.size() || tag2idx[e[j] - min_tag] == BAD_INDEX)
+					throw std::logic_error("Parse msh file failed: element references unknown node");
+				conn.push_back(tag2idx[e[j] - min_tag]);
+			}
+			cmat.push_back(mat);
+		}
+	}
+	r.expect("$EndElements");
+}
+
+/** Sorted vertex triple of a face with the face id (4 * tet + local face index) */
+struct face_key {
+	index v[3];
+	index id;
+	face_key() { }
+	face_key(index a, index b, index c, index id) : id(id) {
+		v[0] = a; v[1] = b; v[2] = c;
+		std::sort(v, v + 3);
+	}
+	static bool less(const face_key &a, const face_key &b) {
+		if (a.v[0] != b.v[0])
+			return a.v[0] < b.v[0];
+		if (a.v[1] != b.v[1])
+			return a.v[1] < b.v[1];
+		return a.v[2] < b.v[2];
+	}
+};
+
+/** Local vertex indices of tetrahedron faces, in the same order as tetrahedron class uses */
+const int tet_face_verts[4][3] = {{1, 2, 3}, {0, 3, 2}, {0, 1, 3}, {0, 2, 1}};
+
+/** Check if (a, b, c) is a cyclic shift of (x[0], x[1], x[2]) */
+bool same_orientation(const index *t, const index *x) {
+	for (int s = 0; s < 3; s++)
+		if (t[0] == x[s] && t[1] == x[(s + 1) % 3] && t[2] == x[(s + 2) % 3])
+			return true;
+	return false;
+}
+
+}
+
+}
+
+msh_mesh::msh_mesh(const char *fn) {
+	msh_reader r(fn);
+	physical_map phys;
+	std::vector<index> tag2idx;
+	uint64_t min_tag = 0;
+	bool has_format = false, has_nodes = false, has_elements = false;
+
+	while (!r.eof()) {
+		std::string section = r.word();
+		/* Binary data starts right after the section header line */
+		if (r.binary())
+			r.skip_line();
+		if (section == "$MeshFormat") {
+			read_format(r);
+			has_format = true;
+			continue;
+		}
+		if (!has_format)
+			throw std::logic_error("Parse msh file failed: $MeshFormat expected at the beginning of file");
+		if (section == "$Entities") {
+			read_entities(r, phys);
+			continue;
+		}
+		if (section == "$Nodes") {
+			read_nodes(r, vert, tag2idx, min_tag);
+			has_nodes = true;
+			continue;
+		}
+		if (section == "$Elements") {
+			if (!has_nodes)
+				throw std::logic_error("Parse msh file failed: $Elements before $Nodes");
+			read_elements(r, phys, tag2idx, min_tag, tet, tetmat, bnd, bndmat);
+			has_elements = true;
+			continue;
+		}
+		if (section.size() < 2 || section[0] != '$')
+			throw std::logic_error("Parse msh file failed: unexpected `" + section + "'");
+		r.skip_to("$End" + section.substr(1));
+	}
+	if (!has_nodes || !has_elements)
+		throw std::logic_error("Parse msh file failed: no $Nodes or $Elements section");
+
+	nV = vert.size() / 3;
+	nT = tetmat.size();
+
+	/* Gmsh orders tetrahedron vertices the other way round */
+	for (index i = 0; i < nT; i++)
+		std::swap(tet[4 * i + 1], tet[4 * i + 2]);
+
+	orient_boundary();
+	nB = bndmat.size();
+}
+
+void msh_mesh::orient_boundary() {
+	if (bndmat.empty())
+		return;
+
+	std::vector<face_key> keys;
+	keys.reserve(4 * nT);
+	for (index i = 0; i < nT; i++) {
+		const index *t = &tet[4 * i];
+		for (int j = 0; j < 4; j++)
+			keys.push_back(face_key(t[tet_face_verts[j][0]], t[tet_face_verts[j][1]], t[tet_face_verts[j][2]], 4 * i + j));
+	}
+	std::sort(keys.begin(), keys.end(), face_key::less);
+
+	index k = 0;
+	for (index i = 0; i < bndmat.size(); i++) {
+		index *b = &bnd[3 * i];
+		face_key key(b[0], b[1], b[2], BAD_INDEX);
+		std::pair<std::vector<face_key>::const_iterator, std::vector<face_key>::const_iterator> range =
+			std::equal_range(keys.begin(), keys.end(), key, face_key::less);
+		ptrdiff_t matches = range.second - range.first;
+		if (matches == 0)
+			throw std::logic_error("Surface element is not a face of any tetrahedron");
+		if (matches > 1)
+			continue;
+
+		index ti = range.first->id / 4;
+		int fi = range.first->id % 4;
+		const index *t = &tet[4 * ti];
+		index x[3] = {t[tet_face_verts[fi][0]], t[tet_face_verts[fi][1]], t[tet_face_verts[fi][2]]};
+		/* Tetrahedron faces look inside, boundary faces should look outside */
+		if (same_orientation(b, x))
+			std::swap(b[1], b[2]);
+
+		for (int j = 0; j < 3; j++)
+			bnd[3 * k + j] = b[j];
+		bndmat[k] = bndmat[i];
+		k++;
+	}
+	bnd.resize(3 * k);
+	bndmat.resize(k);
+}
+
+msh_mesh::~msh_mesh() {
+}
+
+mesh3d::index msh_mesh::num_vertices() const {
+	return nV;
+}
+
+mesh3d::index msh_mesh::num_tetrahedrons() const {
+	return nT;
+}
+
+mesh3d::index msh_mesh::num_bnd_faces() const {
+	return nB;
+}
+
+const double *msh_mesh::vertex_coord(mesh3d::index i) const {
+	return &vert[3 * i];
+}
+
+const mesh3d::index *msh_mesh::tet_verts(mesh3d::index i) const {
+	return &tet[4 * i];
+}
+
+const mesh3d::index *msh_mesh::bnd_verts(mesh3d::index i) const {
+	return &bnd[3 * i];
+}
+
+mesh3d::index msh_mesh::tet_material(mesh3d::index i) const {
+	return tetmat[i];
+}
+
+mesh3d::index msh_mesh::bnd_material(mesh3d::index i) const {
+	return bndmat[i];
+}
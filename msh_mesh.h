@@ -0,0 +1,52 @@
+#ifndef __MESH3D__MSH_MESH_H__
+#define __MESH3D__MSH_MESH_H__
+
+#include "simple_mesh.h"
+#include <vector>
+
+namespace mesh3d {
+
+/** simple_mesh implementation for Gmsh msh format version 4.1, both ASCII and binary
+*
+* Only linear tetrahedrons and triangles are used, other elements (points, lines, etc.)
+* are skipped. Second-order tetrahedrons and triangles and unknown element types are
+* rejected with domain_error.
+* Element material is the first physical tag of its entity, or entity tag if there is none.
+* Triangles shared by two tetrahedrons are dropped, others are oriented outward */
+class msh_mesh : public simple_mesh {
+	index nV;
+	index nB;
+	index nT;
+	std::vector<double> vert;
+	std::vector<index> bnd;
+	std::vector<index> tet;
+	std::vector<index> bndmat;
+	std::vector<index> tetmat;
+
+	void orient_boundary();
+public:
+	/** Constuct msh_mesh from file fn */
+	msh_mesh(const char *fn);
+	/** Destroy msh_mesh object */
+	virtual ~msh_mesh();
+	/** Return number of vertices in mesh */
+	virtual index num_vertices() const;
+	/** Return number of tetrahedrons in mesh */
+	virtual index num_tetrahedrons() const;
+	/** Return number of boundary faces in mesh */
+	virtual index num_bnd_faces() const;
+	/** Return i-th vertex coordinates as an array of 3 doubles */
+	virtual const double *vertex_coord(index i) const;
+	/** Return i-th tetrahedron vertices as an array of 4 indices. Order matters */
+	virtual const index *tet_verts(index i) const;
+	/** Return i-th boundary face vertices as an array of 3 indices. Order matters */
+	virtual const index *bnd_verts(index i) const;
+	/** Return i-th tetrahedron material (color) */
+	virtual index tet_material(index i) const;
+	/** Return i-th boundary face material (color) */
+	virtual index bnd_material(index i) const;
+};
+
+}
+
+#endif
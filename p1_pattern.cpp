@@ -0,0 +1,61 @@
+#include "p1_pattern.h"
+#include "mesh_adjacency.h"
+#include "mesh.h"
+#include "parallel.h"
+#include <algorithm>
+
+using namespace mesh3d;
+
+p1_pattern::p1_pattern(const mesh &m) {
+	mesh_adjacency adj(m);
+	build(m, adj);
+}
+
+p1_pattern::p1_pattern(const mesh &m, const mesh_adjacency &adj) {
+	build(m, adj);
+}
+
+void p1_pattern::build(const mesh &m, const mesh_adjacency &adj) {
+	const csr &vv = adj.vertex_vertices();
+	const index nV = vv.rows();
+	const index nT = m.tets().size();
+
+	/* Rows of vertex_vertices are sorted, the diagonal is merged in place */
+	std::vector<index> &ptr = _pattern.ptr();
+	std::vector<index> &idx = _pattern.idx();
+	ptr.resize(nV + 1);
+	for (index i = 0; i <= nV; i++)
+		ptr[i] = vv.ptr()[i] + i;
+	idx.resize(vv.nnz() + nV);
+	_diag.resize(nV);
+#ifdef USE_OPENMP
+#	pragma omp parallel for num_threads(mesh3d::num_threads())
+#endif
+	for (index i = 0; i < nV; i++) {
+		const index *r = vv.row(i);
+		const index n = vv.size(i);
+		const index k = std::lower_bound(r, r + n, i) - r;
+		index *out = idx.empty() ? 0 : &idx[0] + ptr[i];
+		std::copy(r, r + k, out);
+		out[k] = i;
+		std::copy(r + k, r + n, out + k + 1);
+		_diag[i] = ptr[i] + k;
+	}
+
+	_scatter.resize(16 * nT);
+#ifdef USE_OPENMP
+#	pragma omp parallel for num_threads(mesh3d::num_threads())
+#endif
+	for (index t = 0; t < nT; t++) {
+		const tetrahedron &tet = m.tets(t);
+		index p[4];
+		for (int j = 0; j < 4; j++)
+			p[j] = tet.p(j).idx();
+		for (int i = 0; i < 4; i++) {
+			const index *r = &idx[0] + ptr[p[i]];
+			const index n = ptr[p[i] + 1] - ptr[p[i]];
+			for (int j = 0; j < 4; j++)
+				_scatter[16 * t + 4 * i + j] = ptr[p[i]] + (std::lower_bound(r, r + n, p[j]) - r);
+		}
+	}
+}
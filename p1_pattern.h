@@ -0,0 +1,52 @@
+#ifndef __MESH3D__P1_PATTERN_H__
+#define __MESH3D__P1_PATTERN_H__
+
+#include "common.h"
+#include "csr.h"
+
+#include <vector>
+
+namespace mesh3d {
+
+class mesh;
+class mesh_adjacency;
+
+/** Sparsity pattern of vertex based P1 finite element matrices
+*
+* Row i lists i and every vertex sharing an edge with it, in increasing order.
+* For every tetrahedron a 4x4 scatter map gives positions of its element matrix
+* entries in the value array, so assembly needs no searches:
+*
+*     for (index t = 0; t < nT; t++)
+*         for (int k = 0; k < 16; k++)
+*             a[pat.scatter(t)[k]] += local[t][k]; */
+class p1_pattern {
+	csr _pattern;
+	std::vector<index> _diag;
+	std::vector<index> _scatter;
+
+	void build(const mesh &m, const mesh_adjacency &adj);
+public:
+	/** Build pattern of mesh m, in parallel if built with OpenMP */
+	p1_pattern(const mesh &m);
+	/** Build pattern of mesh m reusing its adjacency tables */
+	p1_pattern(const mesh &m, const mesh_adjacency &adj);
+
+	/** Return number of rows */
+	index rows() const { return _pattern.rows(); }
+	/** Return number of nonzero entries */
+	index nnz() const { return _pattern.nnz(); }
+	/** Return row offsets array of rows() + 1 elements */
+	const std::vector<index> &row_ptr() const { return _pattern.ptr(); }
+	/** Return sorted column indices of every row */
+	const std::vector<index> &col_idx() const { return _pattern.idx(); }
+	/** Return position of diagonal entry of row i in the value array */
+	index diagonal(index i) const { return _diag[i]; }
+	/** Return 16 value array positions of tetrahedron t element matrix,
+	* entry 4 * i + j corresponds to its local vertices i and j */
+	const index *scatter(index t) const { return &_scatter[16 * t]; }
+};
+
+}
+
+#endif
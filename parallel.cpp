@@ -0,0 +1,46 @@
+#include "parallel.h"
+#include <cstdlib>
+
+#ifdef USE_OPENMP
+# include <omp.h>
+#endif
+
+using namespace mesh3d;
+
+namespace mesh3d {
+
+namespace {
+
+int requested_threads = 0;
+
+#ifdef USE_OPENMP
+/** Return MESH3D_NUM_THREADS value or zero if it is not set */
+int env_threads() {
+	const char *env = getenv("MESH3D_NUM_THREADS");
+	if (env) {
+		int n = atoi(env);
+		if (n > 0)
+			return n;
+	}
+	return 0;
+}
+#endif
+
+}
+
+}
+
+int mesh3d::num_threads() {
+#ifdef USE_OPENMP
+	if (requested_threads > 0)
+		return requested_threads;
+	static const int env = env_threads();
+	return env > 0 ? env : omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+void mesh3d::set_num_threads(int n) {
+	requested_threads = n > 0 ? n : 0;
+}
@@ -0,0 +1,129 @@
+#ifndef __MESH3D__PARALLEL_H__
+#define __MESH3D__PARALLEL_H__
+
+#include "common.h"
+#include "mesh.h"
+
+#include <vector>
+
+namespace mesh3d {
+
+/** Return number of threads used by parallel loops of the library
+*
+* Defaults to MESH3D_NUM_THREADS environment variable if set, read once on the first call.
+* Otherwise follows the current OpenMP default, so omp_set_num_threads calls are honored.
+* Always 1 if built without OpenMP */
+int num_threads();
+
+/** Set number of threads used by parallel loops. Nonpositive n restores the default */
+void set_num_threads(int n);
+
+/** Default number of loop iterations in a chunk */
+const index DEFAULT_CHUNK = 1024;
+
+/** Call f(i) for every i in [0, n) in parallel
+*
+* Iterations are split into chunks of the given size, which are handed out to threads
+* dynamically, so uneven iterations are balanced. f should be safe to call concurrently */
+template <class F>
+void parallel_for(index n, const F &f, index chunk = DEFAULT_CHUNK) {
+	const index nc = (n + chunk - 1) / chunk;
+	const int nt = nc > 1 ? num_threads() : 1;
+#ifdef USE_OPENMP
+#	pragma omp parallel for schedule(dynamic, 1) num_threads(nt) if (nt > 1)
+#endif
+	for (index c = 0; c < nc; c++) {
+		const index end = c + 1 < nc ? (c + 1) * chunk : n;
+		for (index i = c * chunk; i < end; i++)
+			f(i);
+	}
+	(void)nt;
+}
+
+/** Reduce f over [0, n) in parallel
+*
+* Each chunk starts from init and accumulates with f(i, acc), chunk results are combined
+* in chunk order with join(acc, other). Chunks do not depend on thread count, so the result
+* is the same for any number of threads */
+template <class T, class F, class J>
+T parallel_reduce(index n, const T &init, const F &f, const J &join, index chunk = DEFAULT_CHUNK) {
+	const index nc = (n + chunk - 1) / chunk;
+	const int nt = nc > 1 ? num_threads() : 1;
+	std::vector<T> part(nc, init);
+#ifdef USE_OPENMP
+#	pragma omp parallel for schedule(dynamic, 1) num_threads(nt) if (nt > 1)
+#endif
+	for (index c = 0; c < nc; c++) {
+		const index end = c + 1 < nc ? (c + 1) * chunk : n;
+		for (index i = c * chunk; i < end; i++)
+			f(i, part[c]);
+	}
+	(void)nt;
+	T acc = init;
+	for (index c = 0; c < nc; c++)
+		join(acc, part[c]);
+	return acc;
+}
+
+namespace detail {
+
+template <class E, class F>
+struct element_call {
+	const ptr_vector<E> &v;
+	const F &f;
+	element_call(const ptr_vector<E> &v, const F &f) : v(v), f(f) { }
+	void operator()(index i) const { f(v[i]); }
+};
+
+template <class E, class T, class F>
+struct element_reduce {
+	const ptr_vector<E> &v;
+	const F &f;
+	element_reduce(const ptr_vector<E> &v, const F &f) : v(v), f(f) { }
+	void operator()(index i, T &acc) const { f(v[i], acc); }
+};
+
+}
+
+/** Call f(tet) for every tetrahedron of m in parallel */
+template <class F>
+void for_each_tet(const mesh &m, const F &f, index chunk = DEFAULT_CHUNK) {
+	parallel_for(m.tets().size(), detail::element_call<tetrahedron, F>(m.tets(), f), chunk);
+}
+
+/** Call f(face) for every face of m, including border ones, in parallel */
+template <class F>
+void for_each_face(const mesh &m, const F &f, index chunk = DEFAULT_CHUNK) {
+	parallel_for(m.faces().size(), detail::element_call<face, F>(m.faces(), f), chunk);
+}
+
+/** Call f(vertex) for every vertex of m in parallel */
+template <class F>
+void for_each_vertex(const mesh &m, const F &f, index chunk = DEFAULT_CHUNK) {
+	parallel_for(m.vertices().size(), detail::element_call<vertex, F>(m.vertices(), f), chunk);
+}
+
+/** Reduce f(tet, acc) over tetrahedrons of m in parallel, see parallel_reduce */
+template <class T, class F, class J>
+T reduce_tets(const mesh &m, const T &init, const F &f, const J &join, index chunk = DEFAULT_CHUNK) {
+	return parallel_reduce(m.tets().size(), init,
+		detail::element_reduce<tetrahedron, T, F>(m.tets(), f), join, chunk);
+}
+
+/** Reduce f(face, acc) over faces of m, including border ones, in parallel, see parallel_reduce */
+template <class T, class F, class J>
+T reduce_faces(const mesh &m, const T &init, const F &f, const J &join, index chunk = DEFAULT_CHUNK) {
+	return parallel_reduce(m.faces().size(), init,
+		detail::element_reduce<face, T, F>(m.faces(), f), join, chunk);
+}
+
+/** Reduce f(vertex, acc) over vertices of m in parallel, see parallel_reduce */
+template <class T, class F, class J>
+T reduce_vertices(const mesh &m, const T &init, const F &f, const J &join, index chunk = DEFAULT_CHUNK) {
+	return parallel_reduce(m.vertices().size(), init,
+		detail::element_reduce<vertex, T, F>(m.vertices(), f), join, chunk);
+}
+
+}
+
+#endif
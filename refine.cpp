@@ -0,0 +1,360 @@
+#include "refine.h"
+#include "mesh.h"
+#include "edge_table.h"
+#include "csr.h"
+#include "parallel.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace mesh3d;
+
+namespace mesh3d {
+
+namespace {
+
+/** Local edge index of tetrahedron for every pair of its local vertices */
+const int tet_local_edge[4][4] = {{-1, 0, 1, 2}, {0, -1, 3, 4}, {1, 3, -1, 5}, {2, 4, 5, -1}};
+
+/** Edge pairs opposite in the octahedron of edge midpoints */
+const int opposite_edges[3][2] = {{0, 5}, {1, 4}, {2, 3}};
+
+vector point(const vector_mesh &vm, index i) {
+	return vector(vm.vert[3 * i], vm.vert[3 * i + 1], vm.vert[3 * i + 2]);
+}
+
+/** Store tetrahedron, swapping two vertices if it is inverted */
+void put_tet(vector_mesh &vm, index pos, index a, index b, index c, index d) {
+	const vector r1 = point(vm, a), r2 = point(vm, b), r3 = point(vm, c), r4 = point(vm, d);
+	if ((r3 - r4).dot((r1 - r4) % (r2 - r4)) < 0)
+		std::swap(a, b);
+	index *t = &vm.tet[4 * pos];
+	t[0] = a;
+	t[1] = b;
+	t[2] = c;
+	t[3] = d;
+}
+
+/** Longest edge propagation path bisection working on vector_mesh in place
+*
+* Vertex incidence lists are copied from the source mesh lazily, on the first
+* touch of a vertex, so the work is proportional to the refined region. */
+class bisector {
+	const mesh &m;
+	vector_mesh &out;
+	const index nT0;
+	std::vector<std::vector<index> > vtets, vbnd;
+	std::vector<char> vinit;
+public:
+	std::vector<index> parent;
+	std::vector<char> touched;
+
+	bisector(const mesh &m, vector_mesh &out)
+		: m(m), out(out), nT0(m.tets().size()),
+		vtets(m.vertices().size()), vbnd(m.vertices().size()),
+		vinit(m.vertices().size(), 0), touched(nT0, 0)
+	{
+		parent.resize(nT0);
+		for (index i = 0; i < nT0; i++)
+			parent[i] = i;
+	}
+
+	void init(index v) {
+		if (vinit[v])
+			return;
+		vinit[v] = 1;
+		const std::vector<tet_vertex> &tl = m.vertices(v).tetrahedrons();
+		for (std::vector<tet_vertex>::const_iterator it = tl.begin(); it != tl.end(); ++it)
+			vtets[v].push_back(it->t->idx());
+		const std::vector<face_vertex> &fl = m.vertices(v).faces();
+		for (std::vector<face_vertex>::const_iterator it = fl.begin(); it != fl.end(); ++it)
+			if (it->f->is_border())
+				vbnd[v].push_back(it->f->idx() - 4 * nT0);
+	}
+
+	/** Strict order of edges by length, ties are resolved by vertex indices */
+	bool longer(index a, index b, index c, index d) const {
+		const double l1 = norm(point(out, a) - point(out, b));
+		const double l2 = norm(point(out, c) - point(out, d));
+		if (l1 != l2)
+			return l1 > l2;
+		if (std::min(a, b) != std::min(c, d))
+			return std::min(a, b) < std::min(c, d);
+		return std::max(a, b) < std::max(c, d);
+	}
+
+	void longest_edge(index t, index &a, index &b) const {
+		const index *p = &out.tet[4 * t];
+		a = p[0];
+		b = p[1];
+		for (int j = 1; j < 6; j++) {
+			const index c = p[edge_table::tet_edge_verts[j][0]], d = p[edge_table::tet_edge_verts[j][1]];
+			if (longer(c, d, a, b)) {
+				a = c;
+				b = d;
+			}
+		}
+	}
+
+	static bool contains(const index *p, int n, index v) {
+		for (int j = 0; j < n; j++)
+			if (p[j] == v)
+				return true;
+		return false;
+	}
+
+	void star(index a, index b, std::vector<index> &s) {
+		init(a);
+		init(b);
+		s.clear();
+		for (std::vector<index>::const_iterator it = vtets[a].begin(); it != vtets[a].end(); ++it)
+			if (contains(&out.tet[4 * *it], 4, b))
+				s.push_back(*it);
+	}
+
+	static void replace(std::vector<index> &list, index from, index to) {
+		*std::find(list.begin(), list.end(), from) = to;
+	}
+
+	/** Bisect edge (a, b), splitting every tetrahedron and boundary face around it */
+	void bisect(index a, index b, const std::vector<index> &s) {
+		const index mv = out.num_vertices();
+		const vector r = 0.5 * (point(out, a) + point(out, b));
+		out.vert.push_back(r.x);
+		out.vert.push_back(r.y);
+		out.vert.push_back(r.z);
+		vtets.push_back(std::vector<index>());
+		vbnd.push_back(std::vector<index>());
+		vinit.push_back(1);
+
+		/* The child keeping the old index gets vertex b replaced, the new one gets vertex a
+		   replaced. Moving a vertex to the edge midpoint halves the volume, keeping its sign */
+		for (std::vector<index>::const_iterator it = s.begin(); it != s.end(); ++it) {
+			const index t = *it, nt = out.num_tetrahedrons();
+			for (int j = 0; j < 4; j++)
+				out.tet.push_back(out.tet[4 * t + j]);
+			out.tetmat.push_back(out.tetmat[t]);
+			parent.push_back(parent[t]);
+			for (int j = 0; j < 4; j++) {
+				const index v = out.tet[4 * t + j];
+				if (v == b)
+					out.tet[4 * t + j] = mv;
+				if (v == a)
+					out.tet[4 * nt + j] = mv;
+				else if (v != b) {
+					init(v);
+					vtets[v].push_back(nt);
+				}
+			}
+			replace(vtets[b], t, nt);
+			vtets[mv].push_back(t);
+			vtets[mv].push_back(nt);
+			if (t < nT0)
+				touched[t] = 1;
+		}
+
+		std::vector<index> fs;
+		for (std::vector<index>::const_iterator it = vbnd[a].begin(); it != vbnd[a].end(); ++it)
+			if (contains(&out.bnd[3 * *it], 3, b))
+				fs.push_back(*it);
+		for (std::vector<index>::const_iterator it = fs.begin(); it != fs.end(); ++it) {
+			const index f = *it, nf = out.num_bnd_faces();
+			for (int j = 0; j < 3; j++)
+				out.bnd.push_back(out.bnd[3 * f + j]);
+			out.bndmat.push_back(out.bndmat[f]);
+			for (int j = 0; j < 3; j++) {
+				const index v = out.bnd[3 * f + j];
+				if (v == b)
+					out.bnd[3 * f + j] = mv;
+				if (v == a)
+					out.bnd[3 * nf + j] = mv;
+				else if (v != b) {
+					init(v);
+					vbnd[v].push_back(nf);
+				}
+			}
+			replace(vbnd[b], f, nf);
+			vbnd[mv].push_back(f);
+			vbnd[mv].push_back(nf);
+		}
+	}
+
+	/** Refine tetrahedron t, bisecting terminal edges along its longest edge propagation path */
+	void refine(index t) {
+		std::vector<index> s;
+		while (!touched[t]) {
+			index cur = t, a, b;
+			while (true) {
+				longest_edge(cur, a, b);
+				star(a, b, s);
+				index next = BAD_INDEX;
+				for (std::vector<index>::const_iterator it = s.begin(); it != s.end(); ++it) {
+					index c, d;
+					longest_edge(*it, c, d);
+					if (longer(c, d, a, b)) {
+						next = *it;
+						break;
+					}
+				}
+				if (next == BAD_INDEX)
+					break;
+				cur = next;
+			}
+			bisect(a, b, s);
+		}
+	}
+};
+
+struct priority_greater {
+	const std::vector<int> &marker;
+	priority_greater(const std::vector<int> &marker) : marker(marker) { }
+	bool operator()(index a, index b) const {
+		return marker[a] > marker[b];
+	}
+};
+
+}
+
+}
+
+void mesh3d::refine_uniform(const mesh &m, vector_mesh &out) {
+	const index nV = m.vertices().size();
+	const index nT = m.tets().size();
+	const index nB = m.faces().size() - 4 * nT;
+	edge_table et(m);
+	const index nE = et.num_edges();
+
+	out.vert.resize(3 * (nV + nE));
+	out.tet.resize(32 * nT);
+	out.tetmat.resize(8 * nT);
+	out.bnd.resize(12 * nB);
+	out.bndmat.resize(4 * nB);
+
+	for (index i = 0; i < nV; i++) {
+		const vector &r = m.vertices(i).r();
+		out.vert[3 * i] = r.x;
+		out.vert[3 * i + 1] = r.y;
+		out.vert[3 * i + 2] = r.z;
+	}
+
+#ifdef USE_OPENMP
+#	pragma omp parallel for num_threads(mesh3d::num_threads())
+#endif
+	for (index e = 0; e < nE; e++) {
+		const index *v = et.edge_verts(e);
+		const vector r = 0.5 * (m.vertices(v[0]).r() + m.vertices(v[1]).r());
+		out.vert[3 * (nV + e)] = r.x;
+		out.vert[3 * (nV + e) + 1] = r.y;
+		out.vert[3 * (nV + e) + 2] = r.z;
+	}
+
+#ifdef USE_OPENMP
+#	pragma omp parallel for num_threads(mesh3d::num_threads())
+#endif
+	for (index i = 0; i < nT; i++) {
+		const tetrahedron &tet = m.tets(i);
+		index p[4], mid[6];
+		for (int j = 0; j < 4; j++)
+			p[j] = tet.p(j).idx();
+		for (int j = 0; j < 6; j++)
+			mid[j] = nV + et.tet_edges(i)[j];
+
+		for (int j = 0; j < 4; j++) {
+			index c[3], k = 0;
+			for (int l = 0; l < 4; l++)
+				if (l != j)
+					c[k++] = mid[tet_local_edge[j][l]];
+			put_tet(out, 8 * i + j, p[j], c[0], c[1], c[2]);
+		}
+
+		/* Split the inner octahedron into four tetrahedrons around its shortest diagonal */
+		int d = 0;
+		double best = -1;
+		for (int k = 0; k < 3; k++) {
+			double l = norm(point(out, mid[opposite_edges[k][0]]) - point(out, mid[opposite_edges[k][1]]));
+			if (best < 0 || l < best) {
+				best = l;
+				d = k;
+			}
+		}
+		const index d0 = mid[opposite_edges[d][0]], d1 = mid[opposite_edges[d][1]];
+		const int a = (d + 1) % 3, b = (d + 2) % 3;
+		const index ring[4] = {
+			mid[opposite_edges[a][0]], mid[opposite_edges[b][0]],
+			mid[opposite_edges[a][1]], mid[opposite_edges[b][1]]
+		};
+		for (int k = 0; k < 4; k++)
+			put_tet(out, 8 * i + 4 + k, d0, d1, ring[k], ring[(k + 1) % 4]);
+
+		for (int k = 0; k < 8; k++)
+			out.tetmat[8 * i + k] = tet.color();
+	}
+
+#ifdef USE_OPENMP
+#	pragma omp parallel for num_threads(mesh3d::num_threads())
+#endif
+	for (index i = 0; i < nB; i++) {
+		const index fi = 4 * nT + i;
+		const face &f = m.faces(fi);
+		index p[3], mid[3];
+		for (int j = 0; j < 3; j++) {
+			p[j] = f.p(j).idx();
+			mid[j] = nV + et.face_edges(fi)[j];
+		}
+		/* mid[j] lies between p[j] and p[j + 1], children keep parent orientation */
+		const index child[4][3] = {
+			{p[0], mid[0], mid[2]},
+			{mid[0], p[1], mid[1]},
+			{mid[2], mid[1], p[2]},
+			{mid[0], mid[1], mid[2]}
+		};
+		for (int k = 0; k < 4; k++) {
+			for (int j = 0; j < 3; j++)
+				out.bnd[12 * i + 3 * k + j] = child[k][j];
+			out.bndmat[4 * i + k] = f.color();
+		}
+	}
+}
+
+void mesh3d::refine_marked(const mesh &m, const std::vector<int> &marker, vector_mesh &out, csr &children) {
+	const index nV = m.vertices().size();
+	const index nT = m.tets().size();
+	const index nB = m.faces().size() - 4 * nT;
+	if (marker.size() != nT)
+		throw std::invalid_argument("refine_marked: marker size does not match number of tetrahedrons");
+
+	out.vert.resize(3 * nV);
+	out.tet.resize(4 * nT);
+	out.tetmat.resize(nT);
+	out.bnd.resize(3 * nB);
+	out.bndmat.resize(nB);
+	for (index i = 0; i < nV; i++) {
+		const vector &r = m.vertices(i).r();
+		out.vert[3 * i] = r.x;
+		out.vert[3 * i + 1] = r.y;
+		out.vert[3 * i + 2] = r.z;
+	}
+	for (index i = 0; i < nT; i++) {
+		const tetrahedron &tet = m.tets(i);
+		for (int j = 0; j < 4; j++)
+			out.tet[4 * i + j] = tet.p(j).idx();
+		out.tetmat[i] = tet.color();
+	}
+	for (index i = 0; i < nB; i++) {
+		const face &f = m.faces(4 * nT + i);
+		for (int j = 0; j < 3; j++)
+			out.bnd[3 * i + j] = f.p(j).idx();
+		out.bndmat[i] = f.color();
+	}
+
+	std::vector<index> marked;
+	for (index i = 0; i < nT; i++)
+		if (marker[i] > 0)
+			marked.push_back(i);
+	std::stable_sort(marked.begin(), marked.end(), priority_greater(marker));
+
+	bisector bs(m, out);
+	for (std::vector<index>::const_iterator it = marked.begin(); it != marked.end(); ++it)
+		bs.refine(*it);
+
+	children.transpose(bs.parent.empty() ? 0 : &bs.parent[0], bs.parent.size(), 1, nT);
+}
@@ -0,0 +1,34 @@
+#ifndef __MESH3D__REFINE_H__
+#define __MESH3D__REFINE_H__
+
+#include "common.h"
+#include "vector_mesh.h"
+#include "csr.h"
+
+#include <vector>
+
+namespace mesh3d {
+
+class mesh;
+
+/** Refine every tetrahedron of m into eight and every boundary face into four
+*
+* Original vertices keep their indices, edge midpoints follow them in edge_table order.
+* Children of i-th tetrahedron are 8i..8i+7 and children of i-th boundary face are
+* 4i..4i+3, they inherit parent colors. Inner octahedrons are split along their
+* shortest diagonal. Runs in parallel over tetrahedrons if built with OpenMP. */
+void refine_uniform(const mesh &m, vector_mesh &out);
+
+/** Refine tetrahedrons of m having positive marker values by longest edge bisection
+*
+* Each marked tetrahedron is bisected at least once, in order of decreasing marker values.
+* Edges are bisected following Rivara's longest edge propagation path, so the result is
+* conforming and children inherit parent colors and face orientation. Original vertices and
+* tetrahedrons keep their indices, new ones are appended. Row i of children lists tetrahedrons
+* of out that lie in i-th tetrahedron of m. The work is proportional to the refined region
+* besides copying the mesh into out. */
+void refine_marked(const mesh &m, const std::vector<int> &marker, vector_mesh &out, csr &children);
+
+}
+
+#endif
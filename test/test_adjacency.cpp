@@ -0,0 +1,70 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "mesh_adjacency.h"
+#include "edge_table.h"
+#include <iostream>
+#include <algorithm>
+
+using namespace mesh3d;
+
+int main() {
+	try {
+		vol_mesh vm("mesh.vol");
+		mesh m(vm);
+		mesh_adjacency adj(m);
+		edge_table et(m);
+
+		const index nV = m.vertices().size();
+		const index nT = m.tets().size();
+		const csr &vv = adj.vertex_vertices();
+		const csr &vt = adj.vertex_tets();
+
+		std::cout << "vertex_vertices nnz = " << vv.nnz() << ", vertex_tets nnz = " << vt.nnz() << std::endl;
+		if (vv.rows() != nV || vv.nnz() != 2 * et.num_edges() || vt.rows() != nV || vt.nnz() != 4 * nT)
+			return 1;
+
+		for (index i = 0; i < nV; i++) {
+			const std::vector<tet_vertex> &tl = m.vertices(i).tetrahedrons();
+			if (vt.size(i) != tl.size())
+				return 1;
+			for (index k = 0; k < vt.size(i); k++) {
+				const tetrahedron &t = m.tets(vt.row(i)[k]);
+				if (k > 0 && vt.row(i)[k] <= vt.row(i)[k - 1])
+					return 1;
+				if (&t.p(0) != &m.vertices(i) && &t.p(1) != &m.vertices(i) &&
+						&t.p(2) != &m.vertices(i) && &t.p(3) != &m.vertices(i))
+					return 1;
+			}
+			for (index k = 0; k < vv.size(i); k++) {
+				const index j = vv.row(i)[k];
+				if (j == i || (k > 0 && j <= vv.row(i)[k - 1]))
+					return 1;
+				if (!std::binary_search(vv.row(j), vv.row(j) + vv.size(j), i))
+					return 1;
+			}
+		}
+
+		index borders = 0;
+		for (index i = 0; i < nT; i++)
+			for (int j = 0; j < 4; j++) {
+				const face &g = m.tets(i).f(j).flip();
+				const index n = adj.tet_tets(i)[j], f = adj.tet_flips(i)[j];
+				if (f != g.idx())
+					return 1;
+				if (g.is_border()) {
+					borders++;
+					if (n != BAD_INDEX)
+						return 1;
+					continue;
+				}
+				if (n != f / 4 || adj.tet_tets(n)[f % 4] != i || adj.tet_flips(n)[f % 4] != 4 * i + j)
+					return 1;
+			}
+		if (borders != m.faces().size() - 4 * nT)
+			return 1;
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,85 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include <iostream>
+#include <sstream>
+#include <stdint.h>
+
+using namespace mesh3d;
+
+void put(std::string &s, index x) {
+	s.append(reinterpret_cast<const char *>(&x), sizeof(x));
+}
+
+int main() {
+	try {
+		std::vector<index> verts;
+		std::vector<dom_vertex> als;
+		verts.push_back(7); als.push_back(dom_vertex(2, 70));
+		verts.push_back(3); als.push_back(dom_vertex(1, 30));
+		verts.push_back(7); als.push_back(dom_vertex(1, 71));
+		verts.push_back(7); als.push_back(dom_vertex(2, 72));
+		alias_table at;
+		at.assign(verts, als);
+		if (at.size() != 2 || at.nnz() != 3 || at.vertices()[0] != 3 || at.vertices()[1] != 7)
+			return 1;
+		if (at.aliases(7).size() != 2 || at.aliases(7).find(1) != 71 || at.aliases(7).find(2) != 72
+				|| at.aliases(7).find(0) != BAD_INDEX || !at.aliases(5).empty() || at.aliases(3).find(1) != 30)
+			return 1;
+
+		vol_mesh vm("mesh.vol");
+		mesh m(vm);
+		std::ostringstream os;
+		m.serialize(os);
+		if (m.aliases().size() != 0)
+			return 1;
+
+		/* Append aliases to serialized mesh: every 10th vertex gets aliases in domains 1 and 3 */
+		std::string s = os.str();
+		const index nV = m.vertices().size();
+		uint64_t nI = 0;
+		std::string tail;
+		for (index i = nV; i-- > 0; )
+			if (i % 10 == 0) {
+				nI++;
+				put(tail, i);
+				put(tail, 2);
+				put(tail, 3);
+				put(tail, 3 * i);
+				put(tail, 1);
+				put(tail, i + 1);
+			}
+		/* Narrow builds write two more header fields with index and color widths */
+		const bool wide = sizeof(index) == 8 && sizeof(color_type) == 8;
+		s.replace((wide ? 6 : 8) * sizeof(uint64_t), sizeof(uint64_t), reinterpret_cast<const char *>(&nI), sizeof(nI));
+		s += tail;
+
+		std::istringstream is(s);
+		mesh m2(is);
+		std::cout << "Interface vertices: " << m2.aliases().size() << ", aliases: " << m2.aliases().nnz() << std::endl;
+		if (m2.aliases().size() != nI || m2.aliases().nnz() != 2 * nI)
+			return 1;
+		for (index i = 0; i < nV; i++) {
+			const alias_list al = m2.aliases(i);
+			if (i % 10 != 0) {
+				if (!al.empty())
+					return 1;
+				continue;
+			}
+			if (al.size() != 2 || al.begin()->domain_id != 1 || al.find(1) != i + 1 || al.find(3) != 3 * i)
+				return 1;
+		}
+
+		std::ostringstream os2;
+		m2.serialize(os2);
+		std::istringstream is2(os2.str());
+		mesh m3(is2);
+		std::ostringstream os3;
+		m3.serialize(os3);
+		if (os2.str() != os3.str() || os2.str().size() != s.size())
+			return 1;
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
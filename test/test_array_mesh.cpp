@@ -0,0 +1,68 @@
+#include "vol_mesh.h"
+#include "vector_mesh.h"
+#include "array_mesh.h"
+#include "mesh.h"
+#include <iostream>
+#include <sstream>
+
+using namespace mesh3d;
+
+std::string serialized(const mesh &m) {
+	std::ostringstream ss;
+	m.serialize(ss);
+	return ss.str();
+}
+
+int main() {
+	try {
+		vol_mesh vm("mesh.vol");
+		vector_mesh data(vm);
+
+		array_mesh am(data.num_vertices(), &data.vert[0],
+			data.num_tetrahedrons(), &data.tet[0], &data.tetmat[0],
+			data.num_bnd_faces(), &data.bnd[0], &data.bndmat[0]);
+
+		bool ok = am.vertex_coord(5) == &data.vert[15] && am.tet_verts(7) == &data.tet[28]
+			&& am.bnd_verts(3) == &data.bnd[9] && am.tet_material(2) == data.tetmat[2];
+		if (!ok)
+			std::cerr << "array_mesh does not refer to caller arrays" << std::endl;
+
+		mesh from_vector(data);
+		mesh from_array(am);
+		const simple_mesh &base = am;
+		mesh from_base(base, 0, 1, false);
+
+		ok = ok && from_array.check(&std::cerr);
+		ok = ok && serialized(from_vector) == serialized(from_array);
+		ok = ok && serialized(from_base) == serialized(from_array) && !from_base.has_geometry();
+		for (index i = 0; ok && i < from_array.tets().size(); i++)
+			ok = from_array.tets(i).volume() == from_vector.tets(i).volume();
+
+		/* Materials not fitting into color type are rejected, not truncated */
+		const index big = 70000;
+		std::vector<index> tetmat(data.tetmat);
+		tetmat[0] = big;
+		array_mesh wide_mat(data.num_vertices(), &data.vert[0],
+			data.num_tetrahedrons(), &data.tet[0], &tetmat[0],
+			data.num_bnd_faces(), &data.bnd[0], &data.bndmat[0]);
+		bool thrown = false;
+		try {
+			mesh w(wide_mat);
+			ok = ok && w.tets(0).color() == big;
+		} catch (std::domain_error &) {
+			thrown = true;
+		}
+		ok = ok && thrown == (big >= BAD_COLOR);
+
+		array_mesh empty(0, 0, 0, 0, 0, 0, 0, 0);
+		mesh e(empty);
+		ok = ok && e.vertices().size() == 0 && e.faces().size() == 0;
+
+		std::cout << "Array mesh: " << from_array.tets().size() << " tets, check "
+			<< (ok ? "OK" : "failed") << std::endl;
+		return ok ? 0 : 1;
+	} catch (std::exception &e) {
+		std::cerr << "Exception: " << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,113 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "parallel.h"
+#include <iostream>
+#include <cstdlib>
+
+#ifdef USE_OPENMP
+# include <omp.h>
+#endif
+
+using namespace mesh3d;
+
+/* Same mesh with every k-th tetrahedron inverted */
+class inverted_mesh : public simple_mesh {
+	const simple_mesh &sm;
+	index k;
+	std::vector<index> tv;
+public:
+	inverted_mesh(const simple_mesh &sm, index k) : sm(sm), k(k), tv(4 * sm.num_tetrahedrons()) {
+		for (index i = 0; i < sm.num_tetrahedrons(); i++) {
+			const index *v = sm.tet_verts(i);
+			for (int j = 0; j < 4; j++)
+				tv[4 * i + j] = v[j];
+			if (i % k == 0)
+				std::swap(tv[4 * i], tv[4 * i + 1]);
+		}
+	}
+	virtual index num_vertices() const { return sm.num_vertices(); }
+	virtual index num_tetrahedrons() const { return sm.num_tetrahedrons(); }
+	virtual index num_bnd_faces() const { return sm.num_bnd_faces(); }
+	virtual const double *vertex_coord(index i) const { return sm.vertex_coord(i); }
+	virtual const index *tet_verts(index i) const { return &tv[4 * i]; }
+	virtual const index *bnd_verts(index i) const { return sm.bnd_verts(i); }
+	virtual index tet_material(index i) const { return sm.tet_material(i); }
+	virtual index bnd_material(index i) const { return sm.bnd_material(i); }
+};
+
+bool same(const check_report &a, const check_report &b) {
+	if (a.total != b.total || a.errors.size() != b.errors.size())
+		return false;
+	for (index i = 0; i < a.errors.size(); i++)
+		if (a.errors[i].kind != b.errors[i].kind || a.errors[i].element != b.errors[i].element ||
+			a.errors[i].local != b.errors[i].local)
+			return false;
+	return true;
+}
+
+int main() {
+	try {
+		vol_mesh vm("mesh.vol");
+		mesh good(vm);
+		if (!good.validate().ok() || !good.check())
+			return 1;
+
+		const index k = 7;
+		inverted_mesh im(vm, k);
+		mesh bad(im);
+
+		check_report topo = bad.validate(CHECK_TOPOLOGY);
+		std::cout << "Topology check: " << topo.total << " problems" << std::endl;
+		if (!topo.ok())
+			return 1;
+
+		check_report full = bad.validate(CHECK_FULL, BAD_INDEX);
+		std::cout << "Full check: " << full.total << " problems" << std::endl;
+		if (full.ok() || full.truncated())
+			return 1;
+		index inverted = 0;
+		for (index i = 0; i < full.errors.size(); i++) {
+			const check_error &e = full.errors[i];
+			if (e.kind != check_error::TET_VOLUME)
+				continue;
+			if (e.element != inverted * k || e.value >= 0)
+				return 1;
+			inverted++;
+		}
+		if (inverted != (bad.tets().size() + k - 1) / k)
+			return 1;
+
+		const index cap = 5;
+		check_report capped = bad.validate(CHECK_FULL, cap);
+		capped.print(std::cout);
+		if (capped.total != full.total || capped.errors.size() != cap || !capped.truncated())
+			return 1;
+		for (index i = 0; i < cap; i++)
+			if (capped.errors[i].kind != full.errors[i].kind ||
+				capped.errors[i].element != full.errors[i].element)
+				return 1;
+
+#ifdef USE_OPENMP
+		/* Without an explicit count the library follows the current OpenMP default */
+		if (!getenv("MESH3D_NUM_THREADS")) {
+			const int threads = omp_get_max_threads();
+			omp_set_num_threads(2);
+			const bool follows = num_threads() == 2;
+			omp_set_num_threads(threads);
+			if (!follows)
+				return 1;
+		}
+#endif
+		set_num_threads(1);
+		check_report serial = bad.validate(CHECK_FULL, cap);
+		set_num_threads(3);
+		check_report parallel = bad.validate(CHECK_FULL, cap);
+		set_num_threads(0);
+		if (!same(serial, capped) || !same(parallel, capped))
+			return 1;
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,96 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "mesh_adjacency.h"
+#include "flux_faces.h"
+#include "coloring.h"
+#include <iostream>
+#include <cmath>
+
+using namespace mesh3d;
+
+int main() {
+	try {
+		vol_mesh vm("mesh.vol");
+		mesh m(vm);
+		mesh_adjacency adj(m);
+		flux_faces ff(m);
+		const index nV = m.vertices().size();
+		const index nT = m.tets().size();
+
+		csr tg, fg;
+		color_tets(adj, tg);
+		color_inner_faces(ff, nT, fg);
+		std::cout << "Tet colors: " << tg.rows() << ", face colors: " << fg.rows() << std::endl;
+		if (tg.nnz() != nT || fg.nnz() != ff.inner().size())
+			return 1;
+
+		std::vector<index> owner(nV, BAD_INDEX);
+		std::vector<int> seen(nT, 0);
+		for (index c = 0; c < tg.rows(); c++)
+			for (index k = 0; k < tg.size(c); k++) {
+				const tetrahedron &t = m.tets(tg.row(c)[k]);
+				seen[t.idx()]++;
+				for (int j = 0; j < 4; j++) {
+					if (owner[t.p(j).idx()] == c)
+						return 1;
+					owner[t.p(j).idx()] = c;
+				}
+			}
+		for (index i = 0; i < nT; i++)
+			if (seen[i] != 1)
+				return 1;
+
+		std::vector<index> tet_owner(nT, BAD_INDEX);
+		for (index c = 0; c < fg.rows(); c++)
+			for (index k = 0; k < fg.size(c); k++) {
+				const inner_face &p = ff.inner()[fg.row(c)[k]];
+				if (tet_owner[p.left] == c || tet_owner[p.right] == c)
+					return 1;
+				tet_owner[p.left] = tet_owner[p.right] = c;
+			}
+
+		/* Lock free scatter of tetrahedron volumes to vertices and flux sums to tetrahedrons */
+		std::vector<double> vs(nV, 0), vref(nV, 0);
+		for (index i = 0; i < nT; i++)
+			for (int j = 0; j < 4; j++)
+				vref[m.tets(i).p(j).idx()] += m.tets(i).volume();
+		for (index c = 0; c < tg.rows(); c++) {
+			const index *row = tg.row(c);
+#ifdef USE_OPENMP
+#	pragma omp parallel for
+#endif
+			for (index k = 0; k < tg.size(c); k++) {
+				const tetrahedron &t = m.tets(row[k]);
+				for (int j = 0; j < 4; j++)
+					vs[t.p(j).idx()] += t.volume();
+			}
+		}
+		std::vector<double> fs(nT, 0), fref(nT, 0);
+		for (index k = 0; k < ff.inner().size(); k++) {
+			const inner_face &p = ff.inner()[k];
+			fref[p.left] += p.area;
+			fref[p.right] -= p.area;
+		}
+		for (index c = 0; c < fg.rows(); c++) {
+			const index *row = fg.row(c);
+#ifdef USE_OPENMP
+#	pragma omp parallel for
+#endif
+			for (index k = 0; k < fg.size(c); k++) {
+				const inner_face &p = ff.inner()[row[k]];
+				fs[p.left] += p.area;
+				fs[p.right] -= p.area;
+			}
+		}
+		for (index i = 0; i < nV; i++)
+			if (std::fabs(vs[i] - vref[i]) > 1e-12 * vref[i])
+				return 1;
+		for (index i = 0; i < nT; i++)
+			if (std::fabs(fs[i] - fref[i]) > 1e-12)
+				return 1;
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,55 @@
+#include "cube_mesh.h"
+#include "mesh.h"
+#include <iostream>
+#include <map>
+#include <cmath>
+
+using namespace mesh3d;
+
+bool check_cube(index n, double size) {
+	cube_mesh cm(n, size);
+	mesh m(cm);
+
+	bool ok = m.check(&std::cerr);
+	ok = ok && m.vertices().size() == (n + 1) * (n + 1) * (n + 1);
+	ok = ok && m.tets().size() == 6 * n * n * n;
+	ok = ok && m.faces().size() == 24 * n * n * n + 12 * n * n;
+
+	double vol = 0;
+	for (index i = 0; i < m.tets().size(); i++)
+		vol += m.tets(i).volume();
+
+	std::map<index, double> surf;
+	for (index i = 4 * m.tets().size(); i < m.faces().size(); i++)
+		surf[m.faces(i).color()] += m.faces(i).surface();
+
+	ok = ok && std::fabs(vol - size * size * size) < 1e-12 * size * size * size;
+	ok = ok && surf.size() == 6;
+	for (std::map<index, double>::const_iterator it = surf.begin(); it != surf.end(); ++it)
+		ok = ok && it->first >= 1 && it->first <= 6 && std::fabs(it->second - size * size) < 1e-12 * size * size;
+
+	std::cout << "Cube " << n << "^3: " << m.tets().size() << " tets, volume " << vol
+		<< ", check " << (ok ? "OK" : "failed") << std::endl;
+	return ok;
+}
+
+int main() {
+	try {
+		bool ok = check_cube(1, 1) && check_cube(3, 2) && check_cube(8, 0.5);
+
+		bool thrown = false;
+		try {
+			cube_mesh empty(0);
+		} catch (std::invalid_argument &) {
+			thrown = true;
+		}
+		if (!thrown) {
+			std::cerr << "Empty cube mesh was not rejected" << std::endl;
+			return 1;
+		}
+		return ok ? 0 : 1;
+	} catch (std::exception &e) {
+		std::cerr << "Exception: " << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,106 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "edge_table.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <stdint.h>
+
+using namespace mesh3d;
+
+bool has(const csr &t, index row, index v) {
+	return std::find(t.row(row), t.row(row) + t.size(row), v) != t.row(row) + t.size(row);
+}
+
+bool same(const csr &a, const csr &b) {
+	return a.ptr() == b.ptr() && a.idx() == b.idx();
+}
+
+/** Return true if edge table stream with u64 word at pos replaced by x is rejected */
+bool rejects(const std::string &data, size_t pos, uint64_t x) {
+	std::string bad(data);
+	bad.replace(8 * pos, sizeof(x), reinterpret_cast<const char *>(&x), sizeof(x));
+	std::stringstream ss(bad);
+	try {
+		edge_table et(ss);
+	} catch (std::domain_error &) {
+		return true;
+	}
+	return false;
+}
+
+int main() {
+	try {
+		vol_mesh vm("mesh.vol");
+		mesh m(vm);
+		edge_table et(m);
+
+		const index nV = m.vertices().size();
+		const index nT = m.tets().size();
+		const index nF = m.faces().size();
+		const index nE = et.num_edges();
+
+		/* Euler characteristic of a ball. Every face is listed twice in the mesh: interior ones
+		   as two tet faces, boundary ones as a tet face and a border face */
+		std::cout << "V = " << nV << ", E = " << nE << ", F = " << nF / 2 << ", T = " << nT << std::endl;
+		if (static_cast<long>(nV) - static_cast<long>(nE) + static_cast<long>(nF / 2) - static_cast<long>(nT) != 1)
+			return 1;
+
+		for (index e = 0; e < nE; e++) {
+			const index *v = et.edge_verts(e);
+			if (v[0] >= v[1])
+				return 1;
+			if (e > 0 && !(et.edge_verts(e - 1)[0] < v[0] ||
+				(et.edge_verts(e - 1)[0] == v[0] && et.edge_verts(e - 1)[1] < v[1])))
+				return 1;
+			if (!has(et.vertex_edges(), v[0], e) || !has(et.vertex_edges(), v[1], e))
+				return 1;
+		}
+		if (et.vertex_edges().nnz() != 2 * nE || et.edge_tets().nnz() != 6 * nT || et.edge_faces().nnz() != 3 * nF)
+			return 1;
+
+		for (index t = 0; t < nT; t++)
+			for (int j = 0; j < 6; j++) {
+				const index e = et.tet_edges(t)[j];
+				index a = m.tets(t).p(edge_table::tet_edge_verts[j][0]).idx();
+				index b = m.tets(t).p(edge_table::tet_edge_verts[j][1]).idx();
+				if (std::min(a, b) != et.edge_verts(e)[0] || std::max(a, b) != et.edge_verts(e)[1])
+					return 1;
+				if (!has(et.edge_tets(), e, t))
+					return 1;
+			}
+
+		for (index f = 0; f < nF; f++)
+			for (int j = 0; j < 3; j++) {
+				const index e = et.face_edges(f)[j];
+				index a = m.faces(f).p(j).idx();
+				index b = m.faces(f).p((j + 1) % 3).idx();
+				if (std::min(a, b) != et.edge_verts(e)[0] || std::max(a, b) != et.edge_verts(e)[1])
+					return 1;
+				if (!has(et.edge_faces(), e, f))
+					return 1;
+			}
+
+		std::stringstream ss;
+		et.serialize(ss);
+		edge_table copy(ss);
+		if (copy.num_edges() != nE || !same(copy.vertex_edges(), et.vertex_edges()) ||
+			!same(copy.edge_tets(), et.edge_tets()) || !same(copy.edge_faces(), et.edge_faces()))
+			return 1;
+		for (index t = 0; t < nT; t++)
+			if (!std::equal(et.tet_edges(t), et.tet_edges(t) + 6, copy.tet_edges(t)))
+				return 1;
+
+		const std::string data = ss.str();
+		const size_t verts = 5, tet_edges = verts + 2 * nE, face_edges = tet_edges + 6 * nT;
+		if (!rejects(data, verts, nV) || !rejects(data, verts + 1, 1ull << 40) ||
+			!rejects(data, tet_edges, nE) || !rejects(data, face_edges + 3 * nF - 1, nE) ||
+			!rejects(data, 2, ~0ull / 2))
+			return 1;
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,160 @@
+#include "vol_mesh.h"
+#include "vtk_stream.h"
+#include "mesh.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <algorithm>
+
+using namespace mesh3d;
+
+bool aligned(const void *p) {
+	return reinterpret_cast<size_t>(p) % field::ALIGNMENT == 0;
+}
+
+bool same_fields(const mesh &a, const mesh &b) {
+	if (a.fields().size() != b.fields().size())
+		return false;
+	for (index k = 0; k < a.fields().size(); k++) {
+		const field &f = a.fields()[k];
+		const field *g = b.fields().find(f.name());
+		if (!g || g->location() != f.location() || g->type() != f.type() ||
+				g->components() != f.components() || g->size() != f.size())
+			return false;
+		const size_t bytes = f.size() * field::type_size(f.type());
+		for (int c = 0; c < f.components(); c++) {
+			const char *p = static_cast<const char *>(f.raw(c));
+			if (!std::equal(p, p + bytes, static_cast<const char *>(g->raw(c))))
+				return false;
+		}
+	}
+	return true;
+}
+
+/* Forward only stream buffer, like a pipe. Seeking fails */
+class pipe_buf : public std::streambuf {
+	std::string data;
+	size_t pos;
+	char ch;
+protected:
+	virtual int_type underflow() {
+		if (pos == data.size())
+			return traits_type::eof();
+		ch = data[pos++];
+		setg(&ch, &ch, &ch + 1);
+		return traits_type::to_int_type(ch);
+	}
+public:
+	pipe_buf(const std::string &data) : data(data), pos(0) { }
+};
+
+int main() {
+	try {
+		vol_mesh vm("mesh.vol");
+		mesh m(vm);
+		const index nV = m.vertices().size();
+		const index nT = m.tets().size();
+		const index nF = m.faces().size();
+
+		field &u = m.fields().add<float>("u", VERTEX_FIELD);
+		field &w = m.fields().add<double>("w", TET_FIELD, 3);
+		field &fc = m.fields().add<int32_t>("face_color", FACE_FIELD);
+		if (u.size() != nV || w.size() != nT || fc.size() != nF || m.fields().size() != 3)
+			return 1;
+		for (int c = 0; c < 3; c++)
+			if (!aligned(w.data<double>(c)))
+				return 1;
+
+		for (index i = 0; i < nV; i++)
+			u.data<float>()[i] = m.vertices(i).r().norm();
+		for (index i = 0; i < nT; i++) {
+			const vector &r = m.tets(i).center();
+			w.data<double>(0)[i] = r.z;
+			w.data<double>(1)[i] = -r.y;
+			w.data<double>(2)[i] = r.x;
+		}
+		for (index i = 0; i < nF; i++)
+			fc.data<int32_t>()[i] = m.faces(i).color();
+
+		bool thrown = false;
+		try {
+			m.fields().add<float>("u", TET_FIELD);
+		} catch (std::invalid_argument &) {
+			thrown = true;
+		}
+		try {
+			u.data<double>();
+			thrown = false;
+		} catch (std::logic_error &) { }
+		if (!thrown)
+			return 1;
+
+		std::ostringstream os;
+		m.serialize(os);
+		/* A second mesh follows in the same stream */
+		m.serialize(os);
+		std::istringstream is(os.str());
+		mesh m2(is);
+		mesh m3(is);
+		if (!same_fields(m, m2) || !same_fields(m, m3))
+			return 1;
+
+		/* Meshes with and without fields, followed by other data, read from a non-seekable stream */
+		mesh plain(vm);
+		std::ostringstream ps;
+		plain.serialize(ps);
+		m.serialize(ps);
+		plain.serialize(ps);
+		const uint64_t tail = 0x1234567890abcdefull;
+		ps.write(reinterpret_cast<const char *>(&tail), sizeof(tail));
+		pipe_buf pb(ps.str());
+		std::istream pipe(&pb);
+		mesh p1(pipe);
+		mesh p2(pipe);
+		mesh p3(pipe);
+		uint64_t tail_read = 0;
+		pipe.read(reinterpret_cast<char *>(&tail_read), sizeof(tail_read));
+		if (!pipe || tail_read != tail || p1.fields().size() != 0 || p3.fields().size() != 0 || !same_fields(m, p2))
+			return 1;
+		if (p3.tets().size() != nT || !p3.check())
+			return 1;
+
+		vtk_stream vtk("fields.vtk");
+		vtk.write_header(m2, "Fields");
+		vtk.close();
+		vtk_stream svtk("fields_surface.vtk");
+		svtk.write_surface_header(m2, "Fields");
+		svtk.close();
+		std::ifstream f("fields.vtk", std::ios::binary);
+		std::string text((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+		if (text.find("VECTORS w double") == std::string::npos || text.find("SCALARS u float 1") == std::string::npos)
+			return 1;
+		std::ifstream sf("fields_surface.vtk", std::ios::binary);
+		std::string stext((std::istreambuf_iterator<char>(sf)), std::istreambuf_iterator<char>());
+		if (stext.find("SCALARS face_color int 1") == std::string::npos || stext.find("VECTORS w") != std::string::npos)
+			return 1;
+
+		/* Vertex fields are written on close, after the mesh is gone */
+		vtk_stream dvtk("fields_dead.vtk");
+		{
+			std::istringstream ds(os.str());
+			mesh dead(ds);
+			dvtk.write_header(dead, "Fields");
+		}
+		dvtk.close();
+		std::ifstream df("fields_dead.vtk", std::ios::binary);
+		std::string dtext((std::istreambuf_iterator<char>(df)), std::istreambuf_iterator<char>());
+		if (dtext != text)
+			return 1;
+
+		m.fields().remove("w");
+		if (m.fields().size() != 2 || m.fields().find("w"))
+			return 1;
+		std::cout << "Fields: " << m2.fields().size() << " read back" << std::endl;
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,66 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "flux_faces.h"
+#include <iostream>
+#include <cmath>
+
+using namespace mesh3d;
+
+int main() {
+	try {
+		vol_mesh vm("mesh.vol");
+		mesh m(vm);
+		flux_faces ff(m);
+
+		const index nT = m.tets().size();
+		const index nB = m.faces().size() - 4 * nT;
+		const std::vector<inner_face> &in = ff.inner();
+		const std::vector<border_face> &bd = ff.border();
+		std::cout << "Inner faces: " << in.size() << ", border faces: " << bd.size()
+			<< " in " << ff.groups() << " groups" << std::endl;
+		if (2 * in.size() + nB != 4 * nT || bd.size() != nB)
+			return 1;
+
+		/* Closed surface of every tetrahedron */
+		std::vector<vector> s(nT);
+		std::vector<int> cnt(nT, 0);
+		for (index k = 0; k < in.size(); k++) {
+			const inner_face &p = in[k];
+			if (p.left >= p.right || (k > 0 && p.left < in[k - 1].left))
+				return 1;
+			if (&m.faces(p.face).tet() != &m.tets(p.left) || &m.faces(p.face).flip().tet() != &m.tets(p.right))
+				return 1;
+			s[p.left] += p.area * p.normal;
+			s[p.right] -= p.area * p.normal;
+			cnt[p.left]++;
+			cnt[p.right]++;
+		}
+		for (index g = 0; g < ff.groups(); g++) {
+			if (g > 0 && ff.group_color(g) <= ff.group_color(g - 1))
+				return 1;
+			for (index k = ff.group_begin(g); k < ff.group_end(g); k++) {
+				const border_face &b = bd[k];
+				if (m.faces(b.face).color() != ff.group_color(g) || (k > ff.group_begin(g) && b.tet < bd[k - 1].tet))
+					return 1;
+				s[b.tet] += b.area * b.normal;
+				cnt[b.tet]++;
+			}
+		}
+		if (ff.groups() == 0 || ff.group_end(ff.groups() - 1) != nB)
+			return 1;
+		for (index i = 0; i < nT; i++) {
+			/* Outward normal of left tetrahedron is directed away from its center */
+			if (cnt[i] != 4 || norm(s[i]) > 1e-12)
+				return 1;
+		}
+		for (index k = 0; k < in.size(); k++) {
+			const inner_face &p = in[k];
+			if (p.normal.dot(m.faces(p.face).center() - m.tets(p.left).center()) <= 0)
+				return 1;
+		}
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,81 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "geometry.h"
+#include <iostream>
+
+using namespace mesh3d;
+
+int main() {
+	try {
+		vol_mesh vm("mesh.vol");
+		mesh m(vm);
+
+		index nV = m.vertices().size();
+		index nF = m.faces().size();
+		index nT = m.tets().size();
+
+		std::vector<double> x(nV), y(nV), z(nV);
+		for (index i = 0; i < nV; i++) {
+			x[i] = m.vertices(i).r().x;
+			y[i] = m.vertices(i).r().y;
+			z[i] = m.vertices(i).r().z;
+		}
+		soa_coords r;
+		r.x = x.data();
+		r.y = y.data();
+		r.z = z.data();
+
+		std::vector<index> fv(3 * nF), tv(4 * nT);
+		for (index i = 0; i < nF; i++)
+			for (int j = 0; j < 3; j++)
+				fv[3 * i + j] = m.faces(i).p(j).idx();
+		for (index i = 0; i < nT; i++)
+			for (int j = 0; j < 4; j++)
+				tv[4 * i + j] = m.tets(i).p(j).idx();
+
+		std::vector<double> fbuf(7 * nF), tbuf(4 * nT);
+		face_geometry fg;
+		fg.nx = &fbuf[0 * nF];
+		fg.ny = &fbuf[1 * nF];
+		fg.nz = &fbuf[2 * nF];
+		fg.cx = &fbuf[3 * nF];
+		fg.cy = &fbuf[4 * nF];
+		fg.cz = &fbuf[5 * nF];
+		fg.surface = &fbuf[6 * nF];
+		tet_geometry tg;
+		tg.cx = &tbuf[0 * nT];
+		tg.cy = &tbuf[1 * nT];
+		tg.cz = &tbuf[2 * nT];
+		tg.volume = &tbuf[3 * nT];
+
+		std::cout << "Best SIMD level: " << best_simd_level() << std::endl;
+		for (int level = SIMD_SCALAR; level <= best_simd_level(); level++) {
+			compute_face_geometry(nF, r, fv.data(), fg, static_cast<simd_level>(level));
+			compute_tet_geometry(nT, r, tv.data(), tg, static_cast<simd_level>(level));
+			for (index i = 0; i < nF; i++) {
+				const face &f = m.faces(i);
+				if (fg.nx[i] != f.normal().x || fg.ny[i] != f.normal().y || fg.nz[i] != f.normal().z ||
+					fg.cx[i] != f.center().x || fg.cy[i] != f.center().y || fg.cz[i] != f.center().z ||
+					fg.surface[i] != f.surface())
+				{
+					std::cerr << "Face #" << i << " geometry differs at SIMD level " << level << std::endl;
+					return 1;
+				}
+			}
+			for (index i = 0; i < nT; i++) {
+				const tetrahedron &t = m.tets(i);
+				if (tg.cx[i] != t.center().x || tg.cy[i] != t.center().y || tg.cz[i] != t.center().z ||
+					tg.volume[i] != t.volume())
+				{
+					std::cerr << "Tet #" << i << " geometry differs at SIMD level " << level << std::endl;
+					return 1;
+				}
+			}
+			std::cout << "SIMD level " << level << ": OK" << std::endl;
+		}
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
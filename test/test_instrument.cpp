@@ -0,0 +1,100 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "vtk_stream.h"
+#include "instrument.h"
+#include <iostream>
+#include <sstream>
+#include <new>
+
+using namespace mesh3d;
+
+bool has_region(const std::map<std::string, region_stats> &r, const char *name, uint64_t calls) {
+	std::map<std::string, region_stats>::const_iterator it = r.find(name);
+	if (it == r.end() || it->second.calls != calls || it->second.seconds < 0) {
+		std::cerr << "Region " << name << " is missing or has wrong call count" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+int handler_calls = 0;
+
+void failing_handler() {
+	handler_calls++;
+	std::set_new_handler(0);
+}
+
+/* This test links mesh3d_alloc_hooks, its operator new should run the new_handler loop */
+bool new_handler_called() {
+	std::set_new_handler(failing_handler);
+	bool thrown = false;
+	try {
+		void *p = ::operator new(~size_t(0) / 2);
+		::operator delete(p);
+	} catch (std::bad_alloc &) {
+		thrown = true;
+	}
+	std::set_new_handler(0);
+	return thrown && handler_calls == 1;
+}
+
+int main() {
+	try {
+		instrument_reset();
+		{
+			vol_mesh vm("mesh.vol");
+			mesh m(vm);
+			m.check();
+			std::stringstream ss;
+			m.serialize(ss);
+			mesh copy(ss);
+			vtk_stream vtk("instrument.vtk");
+			vtk.write_header(copy, "instrument");
+		}
+
+		std::map<std::string, region_stats> r = instrument_regions();
+		std::map<std::string, uint64_t> c = instrument_counters();
+		alloc_stats a = instrument_allocs();
+
+		std::ostringstream json;
+		instrument_dump(json);
+		std::cout << json.str() << std::endl;
+
+		bool ok = json.str().find("\"regions\": {") != std::string::npos;
+		if (instrument_enabled()) {
+			ok = ok && has_region(r, "parse_vol", 1);
+			ok = ok && has_region(r, "mesh::build", 1);
+			ok = ok && has_region(r, "mesh::build.elements", 1);
+			ok = ok && has_region(r, "mesh::build.sort_lists", 1);
+			ok = ok && has_region(r, "mesh::build.flip_search", 1);
+			ok = ok && has_region(r, "mesh::check", 1);
+			ok = ok && has_region(r, "mesh::validate", 1);
+			ok = ok && has_region(r, "mesh::serialize", 1);
+			ok = ok && has_region(r, "mesh::read", 1);
+			ok = ok && has_region(r, "vtk_stream::write_header", 1);
+			ok = ok && has_region(r, "vtk_stream::close", 1);
+			ok = ok && c["mesh::build.tets"] == 1134 && c["mesh::read.tets"] == 1134;
+			ok = ok && r["mesh::build"].allocs >= 1134 && r["mesh::build"].alloc_bytes > 0;
+			ok = ok && r["mesh::build"].allocs >= r["mesh::build.elements"].allocs;
+			ok = ok && a.allocs > 0 && a.frees > 0 && a.peak_bytes >= a.live_bytes;
+
+			instrument_reset();
+			ok = ok && instrument_regions().empty() && instrument_counters().empty();
+			ok = ok && instrument_allocs().allocs == 0;
+		} else {
+			ok = ok && r.empty() && c.empty() && a.allocs == 0;
+		}
+
+		if (!new_handler_called()) {
+			std::cerr << "new_handler was not called on allocation failure" << std::endl;
+			ok = false;
+		}
+
+		std::cout << "Instrumentation " << (instrument_enabled() ? "enabled" : "disabled")
+			<< ", check " << (ok ? "OK" : "failed") << std::endl;
+		return ok ? 0 : 1;
+	} catch (std::exception &e) {
+		std::cerr << "Exception: " << e.what() << std::endl;
+		return 1;
+	}
+}
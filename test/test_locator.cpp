@@ -0,0 +1,90 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "tet_locator.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+using namespace mesh3d;
+
+bool contains(const mesh &m, index t, const vector &p, double eps) {
+	double b[4];
+	tet_locator::barycentric(m, t, p, b);
+	for (int j = 0; j < 4; j++)
+		if (b[j] < -eps)
+			return false;
+	return true;
+}
+
+int main() {
+	try {
+		vol_mesh vm("mesh.vol");
+		mesh m(vm);
+		const double eps = 1e-10;
+		tet_locator loc(m, eps);
+		const index nT = m.tets().size();
+
+		for (index i = 0; i < nT; i++) {
+			double b[4];
+			if (loc.locate(m.tets(i).center(), b) != i)
+				return 1;
+			for (int j = 0; j < 4; j++)
+				if (std::fabs(b[j] - 0.25) > 1e-10)
+					return 1;
+			if (loc.locate_from(m.tets(i).center(), nT - 1 - i) != i)
+				return 1;
+			if (loc.locate(m.tets(i).center(), 0) != i)
+				return 1;
+		}
+
+		vector lo(m.vertices(0).r()), hi(lo);
+		for (index i = 0; i < m.vertices().size(); i++) {
+			const vector &r = m.vertices(i).r();
+			lo = vector(std::min(lo.x, r.x), std::min(lo.y, r.y), std::min(lo.z, r.z));
+			hi = vector(std::max(hi.x, r.x), std::max(hi.y, r.y), std::max(hi.z, r.z));
+		}
+
+		const index n = 2000;
+		std::vector<vector> p(n);
+		srand(1);
+		for (index i = 0; i < n; i++) {
+			vector u(rand() / (RAND_MAX + 1.), rand() / (RAND_MAX + 1.), rand() / (RAND_MAX + 1.));
+			p[i] = lo + (hi - lo) * (1.2 * u - vector(0.1));
+		}
+
+		std::vector<index> tets(n), walked(n), guess(n, 0);
+		std::vector<double> bary(4 * n);
+		loc.locate(n, &p[0], &tets[0], &bary[0]);
+		loc.locate(n, &p[0], &walked[0], 0, &guess[0]);
+
+		index found = 0;
+		for (index i = 0; i < n; i++) {
+			index brute = BAD_INDEX;
+			for (index t = 0; t < nT && brute == BAD_INDEX; t++)
+				if (contains(m, t, p[i], eps))
+					brute = t;
+			if ((brute == BAD_INDEX) != (tets[i] == BAD_INDEX) || (walked[i] == BAD_INDEX) != (tets[i] == BAD_INDEX))
+				return 1;
+			if (tets[i] == BAD_INDEX)
+				continue;
+			found++;
+			if (!contains(m, tets[i], p[i], eps) || !contains(m, walked[i], p[i], eps))
+				return 1;
+			vector r;
+			for (int j = 0; j < 4; j++)
+				r += bary[4 * i + j] * m.tets(tets[i]).p(j).r();
+			if (norm(r - p[i]) > 1e-12 * norm(hi - lo))
+				return 1;
+		}
+		std::cout << found << " of " << n << " points located" << std::endl;
+		if (found == 0 || found == n)
+			return 1;
+
+		if (loc.locate(hi + (hi - lo)) != BAD_INDEX)
+			return 1;
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -37,6 +37,47 @@ int main() {
 		vtk.append_point_data(u.data(), "u");
 		vtk.append_point_data(vc.data(), "vert_color");
 		vtk.close();
+
+		std::vector<int> fc(m.faces().size());
+		std::vector<vec<double> > n(m.faces().size());
+		for (index i = 0; i < m.faces().size(); i++) {
+			const face &f = m.faces(i);
+			fc[i] = f.color();
+			n[i].x = f.normal().x;
+			n[i].y = f.normal().y;
+			n[i].z = f.normal().z;
+		}
+		vtk_stream svtk("surface.vtk");
+		svtk.write_surface_header(m, "Surface");
+		svtk.append_cell_data(fc.data(), "face_color");
+		svtk.append_cell_data(n.data(), "normal");
+		svtk.append_point_data(u.data(), "u");
+		svtk.close();
+		if (svtk.surface_faces().size() != m.faces().size() - 4 * m.tets().size())
+			return 1;
+		for (index i = 0; i < svtk.surface_faces().size(); i++)
+			if (m.faces(svtk.surface_faces()[i]).color() == BAD_INDEX)
+				return 1;
+
+		mesh lazy(vm, 0, 1, false);
+		res = lazy.check(&std::cout);
+		std::cout << "Topology only check: " << (res ? "OK" : "failed") << std::endl;
+		if (!res || lazy.has_geometry())
+			return 1;
+		lazy.update_geometry();
+		for (index i = 0; i < m.faces().size(); i++)
+			if (lazy.faces(i).surface() != m.faces(i).surface() ||
+				norm(lazy.faces(i).normal() - m.faces(i).normal()) != 0 ||
+				norm(lazy.faces(i).center() - m.faces(i).center()) != 0)
+				return 1;
+		for (index i = 0; i < m.tets().size(); i++)
+			if (lazy.tets(i).volume() != m.tets(i).volume() ||
+				norm(lazy.tets(i).center() - m.tets(i).center()) != 0)
+				return 1;
+		res = lazy.check(&std::cout);
+		std::cout << "Deferred geometry check: " << (res ? "OK" : "failed") << std::endl;
+		if (!res)
+			return 1;
 	} catch (std::exception &e) {
 		std::cerr << "Exception occured: " << e.what() << std::endl;
 		return 1;
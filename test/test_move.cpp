@@ -0,0 +1,94 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include <iostream>
+#include <cmath>
+
+using namespace mesh3d;
+
+/* Same mesh with vertex positions replaced */
+class moved_mesh : public simple_mesh {
+	const simple_mesh &sm;
+	std::vector<double> r;
+public:
+	moved_mesh(const simple_mesh &sm) : sm(sm), r(3 * sm.num_vertices()) {
+		for (index i = 0; i < sm.num_vertices(); i++)
+			for (int j = 0; j < 3; j++)
+				r[3 * i + j] = sm.vertex_coord(i)[j];
+	}
+	void move(index i, const vector &p) {
+		r[3 * i] = p.x;
+		r[3 * i + 1] = p.y;
+		r[3 * i + 2] = p.z;
+	}
+	virtual index num_vertices() const { return sm.num_vertices(); }
+	virtual index num_tetrahedrons() const { return sm.num_tetrahedrons(); }
+	virtual index num_bnd_faces() const { return sm.num_bnd_faces(); }
+	virtual const double *vertex_coord(index i) const { return &r[3 * i]; }
+	virtual const index *tet_verts(index i) const { return sm.tet_verts(i); }
+	virtual const index *bnd_verts(index i) const { return sm.bnd_verts(i); }
+	virtual index tet_material(index i) const { return sm.tet_material(i); }
+	virtual index bnd_material(index i) const { return sm.bnd_material(i); }
+};
+
+bool same_geometry(const mesh &a, const mesh &b) {
+	for (index i = 0; i < a.faces().size(); i++)
+		if (a.faces(i).surface() != b.faces(i).surface() ||
+			norm(a.faces(i).normal() - b.faces(i).normal()) != 0 ||
+			norm(a.faces(i).center() - b.faces(i).center()) != 0)
+			return false;
+	for (index i = 0; i < a.tets().size(); i++)
+		if (a.tets(i).volume() != b.tets(i).volume() ||
+			norm(a.tets(i).center() - b.tets(i).center()) != 0)
+			return false;
+	return true;
+}
+
+int main() {
+	try {
+		vol_mesh vm("mesh.vol");
+		mesh m(vm);
+		moved_mesh mm(vm);
+
+		std::vector<index> verts;
+		std::vector<vector> r;
+		for (index i = 0; i < m.vertices().size(); i += 5) {
+			verts.push_back(i);
+			r.push_back(m.vertices(i).r() + 1e-3 * vector(std::sin(i), std::cos(i), std::sin(2. * i)));
+			mm.move(i, r.back());
+		}
+
+		std::vector<index> inverted;
+		m.move_vertices(verts.size(), &verts[0], &r[0], &inverted);
+		mesh ref(mm);
+		if (!inverted.empty() || !same_geometry(m, ref) || !m.check(&std::cout))
+			return 1;
+
+		/* Reflect a vertex through the opposite face of one of its tetrahedrons */
+		const index v = verts[1];
+		const tetrahedron &tet = *m.vertices(v).tetrahedrons()[0].t;
+		const int li = m.vertices(v).tetrahedrons()[0].li;
+		vector p = tet.f(li).center();
+		p = 2 * p - m.vertices(v).r();
+		m.move_vertices(1, &v, &p, &inverted);
+		std::cout << "Inverted " << inverted.size() << " tets" << std::endl;
+		std::vector<index> expected;
+		for (index i = 0; i < m.tets().size(); i++)
+			if (m.tets(i).volume() <= 0)
+				expected.push_back(i);
+		if (inverted.empty() || inverted != expected || m.check())
+			return 1;
+		mm.move(v, p);
+		mesh ref2(mm);
+		if (!same_geometry(m, ref2))
+			return 1;
+
+		mesh lazy(vm, 0, 1, false);
+		lazy.move_vertices(verts.size(), &verts[0], &r[0], &inverted);
+		if (!inverted.empty() || lazy.has_geometry() || norm(lazy.vertices(verts[2]).r() - r[2]) != 0)
+			return 1;
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,93 @@
+#include "vol_mesh.h"
+#include "msh_mesh.h"
+#include "mesh.h"
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+
+using namespace mesh3d;
+
+bool compare(const simple_mesh &a, const simple_mesh &b) {
+	if (a.num_vertices() != b.num_vertices() ||
+		a.num_tetrahedrons() != b.num_tetrahedrons() ||
+		a.num_bnd_faces() != b.num_bnd_faces())
+	{
+		std::cerr << "Element counts differ" << std::endl;
+		return false;
+	}
+	for (index i = 0; i < a.num_vertices(); i++)
+		for (int j = 0; j < 3; j++)
+			if (a.vertex_coord(i)[j] != b.vertex_coord(i)[j]) {
+				std::cerr << "Vertex #" << i << " differs" << std::endl;
+				return false;
+			}
+	for (index i = 0; i < a.num_tetrahedrons(); i++) {
+		for (int j = 0; j < 4; j++)
+			if (a.tet_verts(i)[j] != b.tet_verts(i)[j]) {
+				std::cerr << "Tet #" << i << " differs" << std::endl;
+				return false;
+			}
+		if (a.tet_material(i) != b.tet_material(i)) {
+			std::cerr << "Tet #" << i << " material differs" << std::endl;
+			return false;
+		}
+	}
+	for (index i = 0; i < a.num_bnd_faces(); i++) {
+		for (int j = 0; j < 3; j++)
+			if (a.bnd_verts(i)[j] != b.bnd_verts(i)[j]) {
+				std::cerr << "Boundary face #" << i << " differs" << std::endl;
+				return false;
+			}
+		if (a.bnd_material(i) != b.bnd_material(i)) {
+			std::cerr << "Boundary face #" << i << " material differs" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/** Write ASCII msh file with ten nodes and a single element block of given type */
+void write_msh(const char *fn, int type, const char *nodes) {
+	std::ofstream f(fn);
+	f << "$MeshFormat\n4.1 0 8\n$EndMeshFormat\n$Nodes\n1 10 1 10\n3 1 0 10\n";
+	for (int i = 1; i <= 10; i++)
+		f << i << "\n";
+	for (int i = 0; i < 10; i++)
+		f << (i & 1) << " " << ((i >> 1) & 1) << " " << ((i >> 2) & 1) << "\n";
+	f << "$EndNodes\n$Elements\n1 1 1 1\n0 1 " << type << " 1\n1 " << nodes << "\n$EndElements\n";
+}
+
+int main() {
+	try {
+		vol_mesh vm("mesh.vol");
+		msh_mesh bin("mesh.msh");
+		msh_mesh ascii("mesh_ascii.msh");
+		std::cout << "nV = " << bin.num_vertices() << std::endl;
+		std::cout << "nT = " << bin.num_tetrahedrons() << std::endl;
+		std::cout << "nB = " << bin.num_bnd_faces() << std::endl;
+		if (!compare(vm, bin) || !compare(vm, ascii))
+			return 1;
+		mesh m(bin);
+		bool res = m.check(&std::cout);
+		std::cout << "Mesh check: " << (res ? "OK" : "failed") << std::endl;
+		if (!res)
+			return 1;
+
+		/* Points are skipped, second-order elements are rejected */
+		write_msh("point.msh", 15, "1");
+		msh_mesh point("point.msh");
+		if (point.num_vertices() != 10 || point.num_tetrahedrons() != 0 || point.num_bnd_faces() != 0)
+			return 1;
+		write_msh("tet10.msh", 11, "1 2 3 4 5 6 7 8 9 10");
+		try {
+			msh_mesh tet10("tet10.msh");
+			return 1;
+		} catch (std::domain_error &e) {
+			std::cout << "tet10: " << e.what() << std::endl;
+		}
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,120 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "parallel.h"
+#include <iostream>
+#include <cstdlib>
+
+#ifdef USE_OPENMP
+# include <omp.h>
+#endif
+
+using namespace mesh3d;
+
+struct volume_sum {
+	const mesh &m;
+	volume_sum(const mesh &m) : m(m) { }
+	void operator()(index i, double &acc) const { acc += m.tets(i).volume(); }
+};
+
+struct tet_volume {
+	void operator()(const tetrahedron &t, double &acc) const { acc += t.volume(); }
+};
+
+struct face_count {
+	void operator()(const face &f, index &acc) const { acc += f.is_border() ? 1 : 0; }
+};
+
+struct vertex_count {
+	void operator()(const vertex &, index &acc) const { acc++; }
+};
+
+struct add_index {
+	void operator()(index &a, const index &b) const { a += b; }
+};
+
+struct add {
+	void operator()(double &a, const double &b) const { a += b; }
+};
+
+struct mark_vertex {
+	std::vector<int> &seen;
+	mark_vertex(std::vector<int> &seen) : seen(seen) { }
+	void operator()(const vertex &v) const { seen[v.idx()]++; }
+};
+
+struct scale_face {
+	std::vector<double> &out;
+	scale_face(std::vector<double> &out) : out(out) { }
+	void operator()(const face &f) const { out[f.idx()] = 2 * f.surface(); }
+};
+
+int main() {
+	try {
+		setenv("MESH3D_NUM_THREADS", "3", 1);
+#ifdef USE_OPENMP
+		if (num_threads() != 3)
+			return 1;
+		set_num_threads(2);
+		if (num_threads() != 2)
+			return 1;
+		set_num_threads(0);
+		if (num_threads() != 3)
+			return 1;
+		/* Environment variable takes precedence over the OpenMP default */
+		omp_set_num_threads(5);
+		if (num_threads() != 3)
+			return 1;
+#else
+		if (num_threads() != 1)
+			return 1;
+#endif
+
+		vol_mesh vm("mesh.vol");
+		mesh m(vm);
+		const index nT = m.tets().size();
+
+		double ref = 0;
+		for (int nt = 1; nt <= 4; nt++) {
+			set_num_threads(nt);
+			double v = parallel_reduce(nT, 0., volume_sum(m), add(), 64);
+			if (nt == 1)
+				ref = v;
+			else if (v != ref)
+				return 1;
+		}
+		std::cout << "Volume: " << ref << std::endl;
+
+		for (int nt = 1; nt <= 4; nt++) {
+			set_num_threads(nt);
+			if (reduce_tets(m, 0., tet_volume(), add(), 64) != ref)
+				return 1;
+		}
+		if (reduce_faces(m, index(0), face_count(), add_index(), 100) != m.faces().size() - 4 * nT)
+			return 1;
+		if (reduce_vertices(m, index(0), vertex_count(), add_index(), 16) != m.vertices().size())
+			return 1;
+
+		std::vector<int> seen(m.vertices().size(), 0);
+		for_each_vertex(m, mark_vertex(seen), 16);
+		for (index i = 0; i < seen.size(); i++)
+			if (seen[i] != 1)
+				return 1;
+
+		std::vector<double> s(m.faces().size(), 0);
+		for_each_face(m, scale_face(s), 100);
+		for (index i = 0; i < s.size(); i++)
+			if (s[i] != 2 * m.faces(i).surface())
+				return 1;
+
+		mesh lazy(vm, 0, 1, false);
+		lazy.update_geometry();
+		for (index i = 0; i < nT; i++)
+			if (lazy.tets(i).volume() != m.tets(i).volume())
+				return 1;
+		set_num_threads(0);
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
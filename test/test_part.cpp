@@ -38,7 +38,7 @@ int main() {
 			vtk2.write_header(part, buf);
 			std::vector<float> a(part.vertices().size());
 			for (index i = 0; i < part.vertices().size(); i++) {
-				a[i] = part.vertices(i).aliases().size();
+				a[i] = part.aliases(i).size();
 			}
 			vtk2.append_point_data(a.data(), "aliases");
 			vtk2.close();
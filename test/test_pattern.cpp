@@ -0,0 +1,84 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "p1_pattern.h"
+#include <iostream>
+#include <algorithm>
+#include <map>
+#include <cmath>
+
+using namespace mesh3d;
+
+/* Element stiffness matrix of the Laplace operator, grad phi_i is the inward normal of
+   the face opposite to vertex i divided by 6V */
+void stiffness(const tetrahedron &tet, double *k) {
+	static const int opp[4][3] = {{1, 2, 3}, {0, 3, 2}, {0, 1, 3}, {0, 2, 1}};
+	vector g[4];
+	for (int i = 0; i < 4; i++) {
+		const vector &a = tet.p(opp[i][0]).r(), &b = tet.p(opp[i][1]).r(), &c = tet.p(opp[i][2]).r();
+		vector n = (b - a) % (c - a);
+		if (n.dot(tet.p(i).r() - a) < 0)
+			n = -n;
+		g[i] = n / (6 * tet.volume());
+	}
+	for (int i = 0; i < 4; i++)
+		for (int j = 0; j < 4; j++)
+			k[4 * i + j] = tet.volume() * g[i].dot(g[j]);
+}
+
+int main() {
+	try {
+		vol_mesh vm("mesh.vol");
+		mesh m(vm);
+		p1_pattern pat(m);
+
+		const index nV = m.vertices().size();
+		const index nT = m.tets().size();
+		const std::vector<index> &ptr = pat.row_ptr();
+		const std::vector<index> &col = pat.col_idx();
+
+		std::cout << "Pattern: " << pat.rows() << " rows, " << pat.nnz() << " nonzeros" << std::endl;
+		if (pat.rows() != nV || ptr[nV] != pat.nnz())
+			return 1;
+
+		std::vector<double> a(pat.nnz(), 0);
+		std::map<std::pair<index, index>, double> ref;
+		for (index t = 0; t < nT; t++) {
+			double k[16];
+			stiffness(m.tets(t), k);
+			const index *s = pat.scatter(t);
+			for (int i = 0; i < 16; i++) {
+				a[s[i]] += k[i];
+				ref[std::make_pair(m.tets(t).p(i / 4).idx(), m.tets(t).p(i % 4).idx())] += k[i];
+			}
+		}
+		if (ref.size() != pat.nnz())
+			return 1;
+
+		double scale = 0;
+		for (index i = 0; i < nV; i++)
+			scale = std::max(scale, a[pat.diagonal(i)]);
+
+		for (index i = 0; i < nV; i++) {
+			if (col[pat.diagonal(i)] != i || !(a[pat.diagonal(i)] > 0))
+				return 1;
+			double sum = 0;
+			for (index k = ptr[i]; k < ptr[i + 1]; k++) {
+				const index j = col[k];
+				if (k > ptr[i] && j <= col[k - 1])
+					return 1;
+				if (std::fabs(a[k] - ref[std::make_pair(i, j)]) > 1e-12 * scale)
+					return 1;
+				const index kt = std::lower_bound(&col[ptr[j]], &col[0] + ptr[j + 1], i) - &col[0];
+				if (kt == ptr[j + 1] || col[kt] != i || std::fabs(a[kt] - a[k]) > 1e-12 * scale)
+					return 1;
+				sum += a[k];
+			}
+			if (std::fabs(sum) > 1e-12 * scale)
+				return 1;
+		}
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,163 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "mesh_quality.h"
+#include "vtk_stream.h"
+#include "vector_mesh.h"
+#include <iostream>
+#include <algorithm>
+#include <map>
+#include <cmath>
+
+using namespace mesh3d;
+
+/* A mesh of a single regular tetrahedron */
+class regular_tet : public simple_mesh {
+	double r[12];
+	index t[4];
+	index b[12];
+public:
+	regular_tet() {
+		const double p[4][3] = {{1, 1, 1}, {1, -1, -1}, {-1, 1, -1}, {-1, -1, 1}};
+		for (int i = 0; i < 4; i++)
+			for (int j = 0; j < 3; j++)
+				r[3 * i + j] = p[i][j];
+		index v[4] = {0, 1, 2, 3};
+		vector q[4];
+		for (int i = 0; i < 4; i++)
+			q[i] = vector(p[i][0], p[i][1], p[i][2]);
+		if ((q[2] - q[3]).dot((q[0] - q[3]) % (q[1] - q[3])) < 0)
+			std::swap(v[0], v[1]);
+		for (int i = 0; i < 4; i++)
+			t[i] = v[i];
+		/* Boundary faces are flipped tetrahedron faces */
+		const int f[4][3] = {{1, 3, 2}, {0, 2, 3}, {0, 3, 1}, {0, 1, 2}};
+		for (int i = 0; i < 4; i++)
+			for (int j = 0; j < 3; j++)
+				b[3 * i + j] = v[f[i][j]];
+	}
+	virtual index num_vertices() const { return 4; }
+	virtual index num_tetrahedrons() const { return 1; }
+	virtual index num_bnd_faces() const { return 4; }
+	virtual const double *vertex_coord(index i) const { return r + 3 * i; }
+	virtual const index *tet_verts(index) const { return t; }
+	virtual const index *bnd_verts(index i) const { return b + 3 * i; }
+	virtual index tet_material(index) const { return 1; }
+	virtual index bnd_material(index) const { return 1; }
+};
+
+/* Regular tetrahedron and a flat one sharing its face. Both are given positive or zero
+   orientation, border faces are the unshared faces flipped */
+void regular_and_flat(vector_mesh &vm) {
+	const double p[5][3] = {{1, 1, 1}, {1, -1, -1}, {-1, 1, -1}, {-1, -1, 1}, {-1, -1, -3}};
+	for (int i = 0; i < 5; i++)
+		vm.vert.insert(vm.vert.end(), p[i], p[i] + 3);
+	/* Vertex 4 = v1 + v2 - v0 lies in the plane of face 0 1 2 */
+	const index t[2][4] = {{0, 1, 2, 3}, {0, 1, 2, 4}};
+	for (int k = 0; k < 2; k++) {
+		index v[4] = {t[k][0], t[k][1], t[k][2], t[k][3]};
+		vector q[4];
+		for (int i = 0; i < 4; i++)
+			q[i] = vector(p[v[i]][0], p[v[i]][1], p[v[i]][2]);
+		if ((q[2] - q[3]).dot((q[0] - q[3]) % (q[1] - q[3])) < 0)
+			std::swap(v[0], v[1]);
+		vm.tet.insert(vm.tet.end(), v, v + 4);
+		vm.tetmat.push_back(1);
+	}
+	const int f[4][3] = {{1, 3, 2}, {0, 2, 3}, {0, 3, 1}, {0, 1, 2}};
+	std::map<std::vector<index>, std::vector<index> > faces;
+	for (int k = 0; k < 2; k++)
+		for (int i = 0; i < 4; i++) {
+			std::vector<index> b(3), key(3);
+			for (int j = 0; j < 3; j++)
+				key[j] = b[j] = vm.tet[4 * k + f[i][j]];
+			std::sort(key.begin(), key.end());
+			if (faces.count(key))
+				faces.erase(key);
+			else
+				faces[key] = b;
+		}
+	for (std::map<std::vector<index>, std::vector<index> >::const_iterator it = faces.begin(); it != faces.end(); ++it) {
+		vm.bnd.insert(vm.bnd.end(), it->second.begin(), it->second.end());
+		vm.bndmat.push_back(1);
+	}
+}
+
+bool close(double a, double b) {
+	return std::fabs(a - b) < 1e-12 * std::max(1., std::fabs(b));
+}
+
+int main() {
+	try {
+		regular_tet rt;
+		mesh one(rt);
+		if (!one.check(&std::cout))
+			return 1;
+		mesh_quality q1(one);
+		const double edge = std::sqrt(8.);
+		const double dihedral = 180 / std::acos(-1.) * std::acos(1. / 3);
+		if (!close(q1.values(ASPECT_RATIO)[0], 1) || !close(q1.values(RADIUS_RATIO)[0], 1) ||
+			!close(q1.values(MIN_DIHEDRAL)[0], dihedral) || !close(q1.values(MAX_DIHEDRAL)[0], dihedral) ||
+			!close(q1.values(MIN_EDGE)[0], edge) || !close(q1.values(MAX_EDGE)[0], edge) ||
+			!close(q1.min_length_scale(), std::sqrt(2. / 3) * edge))
+			return 1;
+
+		/* Degenerate tetrahedron values are kept out of summaries and bins */
+		vector_mesh rf;
+		regular_and_flat(rf);
+		mesh two(rf, 0, 1, false);
+		mesh_quality q2(two, 4);
+		if (std::isfinite(q2.values(ASPECT_RATIO)[1]))
+			return 1;
+		for (int k = 0; k < NUM_QUALITY_MEASURES; k++) {
+			const quality_histogram &h = q2.histogram(static_cast<quality_measure>(k));
+			index cnt = 0;
+			for (index b = 0; b < h.counts.size(); b++)
+				cnt += h.counts[b];
+			if (cnt + h.nonfinite != 2 || !std::isfinite(h.min) || !std::isfinite(h.max) || !std::isfinite(h.mean))
+				return 1;
+		}
+		const quality_histogram &ha = q2.histogram(ASPECT_RATIO);
+		if (ha.nonfinite != 1 || ha.min_tet != 0 || ha.max_tet != 0 || !close(ha.mean, 1))
+			return 1;
+
+		vol_mesh vm("mesh.vol");
+		mesh m(vm);
+		mesh_quality q(m, 10);
+		const index nT = m.tets().size();
+		vtk_stream vtk("quality.vtk");
+		vtk.write_header(m, "Quality");
+		for (int k = 0; k < NUM_QUALITY_MEASURES; k++) {
+			quality_measure qm = static_cast<quality_measure>(k);
+			const quality_histogram &h = q.histogram(qm);
+			std::cout << mesh_quality::name(qm) << ": min = " << h.min << ", max = " << h.max
+				<< ", mean = " << h.mean << std::endl;
+			const std::vector<double> &v = q.values(qm);
+			index cnt = 0;
+			for (index b = 0; b < h.counts.size(); b++)
+				cnt += h.counts[b];
+			if (cnt != nT || h.nonfinite != 0 || v[h.min_tet] != h.min || v[h.max_tet] != h.max)
+				return 1;
+			for (index i = 0; i < nT; i++)
+				if (v[i] < h.min || v[i] > h.max)
+					return 1;
+			vtk.append_cell_data(&v[0], mesh_quality::name(qm));
+		}
+		vtk.close();
+
+		for (index i = 0; i < nT; i++) {
+			const double s = q.values(RADIUS_RATIO)[i];
+			if (!(s > 0 && s <= 1 + 1e-12) || q.values(ASPECT_RATIO)[i] < 1 - 1e-12 ||
+				q.values(MIN_DIHEDRAL)[i] > dihedral + 1e-9 || q.values(MAX_DIHEDRAL)[i] < dihedral - 1e-9)
+				return 1;
+			const double h = 3 * m.tets(i).volume() / std::max(
+				std::max(m.tets(i).f(0).surface(), m.tets(i).f(1).surface()),
+				std::max(m.tets(i).f(2).surface(), m.tets(i).f(3).surface()));
+			if (std::fabs(q.values(MIN_HEIGHT)[i] - h) > 1e-12 * h)
+				return 1;
+		}
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
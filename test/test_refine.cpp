@@ -0,0 +1,126 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "refine.h"
+#include <iostream>
+#include <map>
+#include <cmath>
+
+using namespace mesh3d;
+
+double volume_by_color(const mesh &m, std::map<index, double> &vol) {
+	double total = 0;
+	for (index i = 0; i < m.tets().size(); i++) {
+		vol[m.tets(i).color()] += m.tets(i).volume();
+		total += m.tets(i).volume();
+	}
+	return total;
+}
+
+double surface_by_color(const mesh &m, std::map<index, double> &surf) {
+	double total = 0;
+	for (index i = 4 * m.tets().size(); i < m.faces().size(); i++) {
+		surf[m.faces(i).color()] += m.faces(i).surface();
+		total += m.faces(i).surface();
+	}
+	return total;
+}
+
+bool same(const std::map<index, double> &a, const std::map<index, double> &b) {
+	if (a.size() != b.size())
+		return false;
+	for (std::map<index, double>::const_iterator it = a.begin(), jt = b.begin(); it != a.end(); ++it, ++jt)
+		if (it->first != jt->first || std::fabs(it->second - jt->second) > 1e-12 * std::fabs(it->second))
+			return false;
+	return true;
+}
+
+bool check_marked(const mesh &m, const std::vector<int> &marker) {
+	vector_mesh vm;
+	csr children;
+	refine_marked(m, marker, vm, children);
+	mesh fine(vm);
+	bool res = fine.check(&std::cout);
+	std::cout << "Locally refined mesh: " << fine.tets().size() << " tets, check " << (res ? "OK" : "failed") << std::endl;
+	if (!res || children.rows() != m.tets().size() || children.nnz() != fine.tets().size())
+		return false;
+
+	std::map<index, double> v1, v2, s1, s2;
+	volume_by_color(m, v1);
+	volume_by_color(fine, v2);
+	surface_by_color(m, s1);
+	surface_by_color(fine, s2);
+	if (!same(v1, v2) || !same(s1, s2))
+		return false;
+
+	for (index i = 0; i < m.tets().size(); i++) {
+		if (marker[i] > 0 && children.size(i) < 2)
+			return false;
+		double v = 0;
+		for (index k = 0; k < children.size(i); k++) {
+			const tetrahedron &t = fine.tets(children.row(i)[k]);
+			if (t.color() != m.tets(i).color())
+				return false;
+			v += t.volume();
+		}
+		if (std::fabs(v - m.tets(i).volume()) > 1e-12 * m.tets(i).volume())
+			return false;
+	}
+	return true;
+}
+
+int main() {
+	try {
+		vol_mesh vm("mesh.vol");
+		mesh m(vm);
+		vector_mesh fine_vm;
+		refine_uniform(m, fine_vm);
+		mesh fine(fine_vm);
+		bool res = fine.check(&std::cout);
+		std::cout << "Refined mesh: " << fine.vertices().size() << " vertices, "
+			<< fine.tets().size() << " tets, check " << (res ? "OK" : "failed") << std::endl;
+		if (!res)
+			return 1;
+
+		const index nT = m.tets().size();
+		const index nB = m.faces().size() - 4 * nT;
+		if (fine.tets().size() != 8 * nT || fine.faces().size() != 32 * nT + 4 * nB)
+			return 1;
+
+		std::map<index, double> v1, v2, s1, s2;
+		volume_by_color(m, v1);
+		volume_by_color(fine, v2);
+		surface_by_color(m, s1);
+		surface_by_color(fine, s2);
+		if (!same(v1, v2) || !same(s1, s2))
+			return 1;
+
+		for (index i = 0; i < nT; i++) {
+			double v = 0;
+			for (int k = 0; k < 8; k++) {
+				if (fine.tets(8 * i + k).color() != m.tets(i).color())
+					return 1;
+				v += fine.tets(8 * i + k).volume();
+			}
+			if (std::fabs(v - m.tets(i).volume()) > 1e-12 * m.tets(i).volume())
+				return 1;
+		}
+
+		std::vector<int> marker(nT, 0);
+		for (index i = 0; i < nT; i++)
+			if (m.tets(i).center().x < m.tets(0).center().x)
+				marker[i] = 1;
+		if (!check_marked(m, marker))
+			return 1;
+
+		std::vector<int> one(nT, 0);
+		one[nT / 2] = 1;
+		if (!check_marked(m, one))
+			return 1;
+		if (!check_marked(fine, std::vector<int>(fine.tets().size(), 1)))
+			return 1;
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
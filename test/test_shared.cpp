@@ -0,0 +1,82 @@
+#include "vol_mesh.h"
+#include "vector_mesh.h"
+#include "mesh.h"
+#include <iostream>
+#include <cmath>
+
+using namespace mesh3d;
+
+double total_volume(const mesh &m) {
+	double v = 0;
+	for (index i = 0; i < m.tets().size(); i++)
+		v += m.tets(i).volume();
+	return v;
+}
+
+bool consistent(const mesh &m) {
+	for (index i = 0; i < m.tets().size(); i++)
+		for (int j = 0; j < 4; j++)
+			if (&m.tets(i).p(j) != &m.vertices(m.tets(i).p(j).idx()))
+				return false;
+	return m.check();
+}
+
+#if __cplusplus >= 201103L
+mesh load(const char *fn) {
+	vol_mesh vm(fn);
+	mesh m(vm);
+	return m;
+}
+#endif
+
+int main() {
+	try {
+		vol_mesh vm("mesh.vol");
+		mesh a(vm);
+		const index nT = a.tets().size();
+		const double vol = total_volume(a);
+
+		vector_mesh empty_vm;
+		mesh b(empty_vm);
+		a.swap(b);
+		if (a.tets().size() != 0 || b.tets().size() != nT || !consistent(b))
+			return 1;
+
+#if __cplusplus >= 201103L
+		mesh c = load("mesh.vol");
+		if (c.tets().size() != nT || !consistent(c))
+			return 1;
+
+		const tetrahedron *t0 = &b.tets(0);
+		mesh d(static_cast<mesh &&>(b));
+		if (b.tets().size() != 0 || d.tets().size() != nT || &d.tets(0) != t0 || !consistent(d))
+			return 1;
+		d = static_cast<mesh &&>(c);
+		if (c.tets().size() != 0 || d.tets().size() != nT || !consistent(d))
+			return 1;
+
+		shared_mesh s = freeze(static_cast<mesh &&>(d));
+		shared_mesh s2 = s;
+		if (d.tets().size() != 0 || s->tets().size() != nT || s2.use_count() != 2)
+			return 1;
+
+		/* Concurrent readers of one frozen mesh */
+		int bad = 0;
+#ifdef USE_OPENMP
+#	pragma omp parallel for reduction(+:bad)
+#endif
+		for (int k = 0; k < 8; k++) {
+			shared_mesh local = s;
+			if (std::fabs(total_volume(*local) - vol) > 1e-12 * vol)
+				bad++;
+		}
+		if (bad)
+			return 1;
+		std::cout << "Shared mesh: " << s->tets().size() << " tets, volume " << total_volume(*s) << std::endl;
+#endif
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
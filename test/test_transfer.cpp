@@ -0,0 +1,106 @@
+#include "vol_mesh.h"
+#include "mesh.h"
+#include "mesh_transfer.h"
+#include <iostream>
+#include <cmath>
+
+using namespace mesh3d;
+
+double linear(const vector &r) {
+	return 1 + 2 * r.x - 3 * r.y + 0.5 * r.z;
+}
+
+int main() {
+	try {
+		vol_mesh vm("mesh.vol");
+		mesh src(vm);
+		mesh dst(vm);
+
+		/* Shake interior vertices of the target mesh, so tetrahedrons differ but the domain does not */
+		double hmin = -1;
+		for (index i = 0; i < src.tets().size(); i++) {
+			double h = std::pow(src.tets(i).volume(), 1. / 3);
+			if (hmin < 0 || h < hmin)
+				hmin = h;
+		}
+		std::vector<bool> border(src.vertices().size(), false);
+		for (index i = 4 * src.tets().size(); i < src.faces().size(); i++)
+			for (int j = 0; j < 3; j++)
+				border[src.faces(i).p(j).idx()] = true;
+		std::vector<index> verts;
+		std::vector<vector> r;
+		for (index i = 0; i < src.vertices().size(); i++)
+			if (!border[i]) {
+				verts.push_back(i);
+				r.push_back(src.vertices(i).r() + 0.1 * hmin * vector(std::sin(i), std::cos(3. * i), std::sin(5. * i)));
+			}
+		std::vector<index> inverted;
+		dst.move_vertices(verts.size(), &verts[0], &r[0], &inverted);
+		if (!inverted.empty() || !dst.check())
+			return 1;
+
+		const index nV = src.vertices().size();
+		const index nT = src.tets().size();
+
+		vector q[4];
+		for (int j = 0; j < 4; j++)
+			q[j] = src.tets(0).p(j).r();
+		if (std::fabs(mesh_transfer::overlap_volume(q, q) - src.tets(0).volume()) > 1e-12 * src.tets(0).volume())
+			return 1;
+
+		mesh_transfer tr(src, dst);
+		std::cout << "Unmapped vertices: " << tr.unmapped_vertices()
+			<< ", unmapped cells: " << tr.unmapped_cells() << std::endl;
+		if (tr.unmapped_cells() != 0)
+			return 1;
+
+		/* Linear field is reproduced at every mapped vertex */
+		std::vector<double> u(2 * nV), v(2 * nV, -1);
+		for (index i = 0; i < nV; i++) {
+			u[2 * i] = linear(src.vertices(i).r());
+			u[2 * i + 1] = 1;
+		}
+		tr.vertex_data(&u[0], &v[0], 2);
+		index mapped = 0;
+		for (index i = 0; i < nV; i++) {
+			if (v[2 * i + 1] == -1)
+				continue;
+			mapped++;
+			if (std::fabs(v[2 * i] - linear(dst.vertices(i).r())) > 1e-10 || std::fabs(v[2 * i + 1] - 1) > 1e-12)
+				return 1;
+		}
+		if (mapped + tr.unmapped_vertices() != nV || mapped < nV / 2)
+			return 1;
+
+		/* Cell field integral is conserved */
+		std::vector<double> a(nT), b(nT);
+		double ia = 0, ib = 0;
+		for (index i = 0; i < nT; i++) {
+			a[i] = linear(src.tets(i).center());
+			ia += a[i] * src.tets(i).volume();
+		}
+		tr.cell_data(&a[0], &b[0]);
+		for (index i = 0; i < nT; i++)
+			ib += b[i] * dst.tets(i).volume();
+		std::cout << "Integral: " << ia << " -> " << ib << std::endl;
+		if (std::fabs(ia - ib) > 1e-10 * std::fabs(ia))
+			return 1;
+
+		mesh_transfer near(src, dst, CELL_NEAREST);
+		std::vector<double> c(nT, 0), d(nT, 0);
+		for (index i = 0; i < nT; i++)
+			c[i] = i;
+		near.cell_data(&c[0], &d[0]);
+		for (index i = 0; i < nT; i++) {
+			index t = static_cast<index>(d[i]);
+			double bary[4];
+			tet_locator::barycentric(src, t, dst.tets(i).center(), bary);
+			if (*std::min_element(bary, bary + 4) < -1e-10)
+				return 1;
+		}
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
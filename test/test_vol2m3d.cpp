@@ -0,0 +1,56 @@
+#include "vol2m3d.h"
+#include "vol_mesh.h"
+#include "mesh.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+using namespace mesh3d;
+
+int main() {
+	try {
+		/* Tiny memory limit to force many sorted runs */
+		vol_to_m3d("mesh.vol", "converted.m3d", 4096);
+
+		vol_mesh vm("mesh.vol");
+		mesh m(vm);
+		std::ostringstream expected;
+		m.serialize(expected);
+
+		std::ifstream f("converted.m3d", std::ios::in | std::ios::binary);
+		std::ostringstream converted;
+		converted << f.rdbuf();
+
+		if (converted.str() != expected.str()) {
+			std::cerr << "Converted file differs from mesh::serialize output" << std::endl;
+			return 1;
+		}
+
+		/* Runs may be placed into a chosen directory, a missing one is reported */
+		vol_to_m3d("mesh.vol", "converted_here.m3d", 4096, ".");
+		std::ifstream g("converted_here.m3d", std::ios::in | std::ios::binary);
+		std::ostringstream here;
+		here << g.rdbuf();
+		if (here.str() != expected.str())
+			return 1;
+		bool thrown = false;
+		try {
+			vol_to_m3d("mesh.vol", "converted_missing.m3d", 4096, "no_such_directory");
+		} catch (std::runtime_error &) {
+			thrown = true;
+		}
+		if (!thrown)
+			return 1;
+
+		std::istringstream is(converted.str());
+		mesh cm(is);
+		bool res = cm.check(&std::cout);
+		std::cout << "Mesh check: " << (res ? "OK" : "failed") << std::endl;
+		if (!res)
+			return 1;
+	} catch (std::exception &e) {
+		std::cerr << "Exception occured: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
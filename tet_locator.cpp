@@ -0,0 +1,252 @@
+#include "tet_locator.h"
+#include "mesh.h"
+#include "parallel.h"
+#include <algorithm>
+#include <utility>
+
+using namespace mesh3d;
+
+namespace mesh3d {
+
+namespace {
+
+/** Maximum number of tetrahedrons in a leaf */
+const index LEAF_SIZE = 4;
+/** Maximum number of steps in neighbour walk before falling back to hierarchy search */
+const int MAX_WALK = 256;
+/** Bits per axis in Morton codes */
+const int MORTON_BITS = 21;
+
+/** Spread lower 21 bits of x so there are two zero bits between every pair of bits */
+uint64_t spread(uint64_t x) {
+	x &= 0x1fffff;
+	x = (x | x << 32) & 0x1f00000000ffffull;
+	x = (x | x << 16) & 0x1f0000ff0000ffull;
+	x = (x | x << 8) & 0x100f00f00f00f00full;
+	x = (x | x << 4) & 0x10c30c30c30c30c3ull;
+	x = (x | x << 2) & 0x1249249249249249ull;
+	return x;
+}
+
+uint64_t quantize(double x, double lo, double scale) {
+	double q = (x - lo) * scale;
+	const double top = (1 << MORTON_BITS) - 1;
+	if (!(q > 0))
+		return 0;
+	if (q > top)
+		q = top;
+	return static_cast<uint64_t>(q);
+}
+
+int highest_bit(uint64_t x) {
+	int bit = 0;
+	while (x >>= 1)
+		bit++;
+	return bit;
+}
+
+bool inside(const double *lo, const double *hi, const vector &p) {
+	return p.x >= lo[0] && p.x <= hi[0] &&
+		p.y >= lo[1] && p.y <= hi[1] &&
+		p.z >= lo[2] && p.z <= hi[2];
+}
+
+}
+
+}
+
+tet_locator::tet_locator(const mesh &m, double eps) : m(m), eps(eps) {
+	const index nT = m.tets().size();
+	if (nT == 0)
+		return;
+
+	vector lo(m.vertices(0).r()), hi(lo);
+	for (index i = 1; i < m.vertices().size(); i++) {
+		const vector &r = m.vertices(i).r();
+		lo.x = std::min(lo.x, r.x); hi.x = std::max(hi.x, r.x);
+		lo.y = std::min(lo.y, r.y); hi.y = std::max(hi.y, r.y);
+		lo.z = std::min(lo.z, r.z); hi.z = std::max(hi.z, r.z);
+	}
+	const double extent = std::max(hi.x - lo.x, std::max(hi.y - lo.y, hi.z - lo.z));
+	const double scale = extent > 0 ? (1 << MORTON_BITS) / extent : 0;
+
+	std::vector<std::pair<uint64_t, index> > keys(nT);
+#ifdef USE_OPENMP
+#	pragma omp parallel for num_threads(mesh3d::num_threads())
+#endif
+	for (index i = 0; i < nT; i++) {
+		const tetrahedron &tet = m.tets(i);
+		vector c = tet.p(0).r();
+		for (int j = 1; j < 4; j++)
+			c += tet.p(j).r();
+		c *= 0.25;
+		keys[i].first = spread(quantize(c.x, lo.x, scale)) |
+			spread(quantize(c.y, lo.y, scale)) << 1 |
+			spread(quantize(c.z, lo.z, scale)) << 2;
+		keys[i].second = i;
+	}
+	std::sort(keys.begin(), keys.end());
+
+	std::vector<uint64_t> codes(nT);
+	order.resize(nT);
+	for (index i = 0; i < nT; i++) {
+		codes[i] = keys[i].first;
+		order[i] = keys[i].second;
+	}
+
+	nodes.reserve(2 * (nT / LEAF_SIZE + 1));
+	build(codes, 0, nT);
+	refit();
+}
+
+index tet_locator::build(const std::vector<uint64_t> &codes, index first, index last) {
+	const index id = nodes.size();
+	nodes.push_back(node());
+	nodes[id].right = BAD_INDEX;
+	nodes[id].first = first;
+	nodes[id].last = last;
+	if (last - first <= LEAF_SIZE)
+		return id;
+
+	/* Split at the highest bit which differs in the range, or at the middle for equal codes */
+	index split = first + (last - first) / 2;
+	const uint64_t a = codes[first], b = codes[last - 1];
+	if (a != b) {
+		const uint64_t mask = 1ull << highest_bit(a ^ b);
+		index l = first, r = last - 1;
+		while (r - l > 1) {
+			index c = l + (r - l) / 2;
+			if (codes[c] & mask)
+				r = c;
+			else
+				l = c;
+		}
+		split = r;
+	}
+
+	build(codes, first, split);
+	const index right = build(codes, split, last);
+	nodes[id].right = right;
+	return id;
+}
+
+void tet_locator::refit() {
+	const index nN = nodes.size();
+
+#ifdef USE_OPENMP
+#	pragma omp parallel for num_threads(mesh3d::num_threads())
+#endif
+	for (index i = 0; i < nN; i++) {
+		node &n = nodes[i];
+		if (n.right != BAD_INDEX)
+			continue;
+		const vector &r0 = m.tets(order[n.first]).p(0).r();
+		n.lo[0] = n.hi[0] = r0.x;
+		n.lo[1] = n.hi[1] = r0.y;
+		n.lo[2] = n.hi[2] = r0.z;
+		for (index k = n.first; k < n.last; k++) {
+			const tetrahedron &tet = m.tets(order[k]);
+			for (int j = 0; j < 4; j++) {
+				const vector &r = tet.p(j).r();
+				n.lo[0] = std::min(n.lo[0], r.x); n.hi[0] = std::max(n.hi[0], r.x);
+				n.lo[1] = std::min(n.lo[1], r.y); n.hi[1] = std::max(n.hi[1], r.y);
+				n.lo[2] = std::min(n.lo[2], r.z); n.hi[2] = std::max(n.hi[2], r.z);
+			}
+		}
+	}
+
+	/* Children always follow their parent, so a reverse sweep goes bottom up */
+	for (index i = nN; i-- > 0; ) {
+		node &n = nodes[i];
+		if (n.right == BAD_INDEX)
+			continue;
+		const node &l = nodes[i + 1];
+		const node &r = nodes[n.right];
+		for (int d = 0; d < 3; d++) {
+			n.lo[d] = std::min(l.lo[d], r.lo[d]);
+			n.hi[d] = std::max(l.hi[d], r.hi[d]);
+		}
+	}
+}
+
+void tet_locator::barycentric(const mesh &m, index t, const vector &p, double *bary) {
+	const tetrahedron &tet = m.tets(t);
+	const vector &r4 = tet.p(3).r();
+	const vector a = tet.p(0).r() - r4;
+	const vector b = tet.p(1).r() - r4;
+	const vector c = tet.p(2).r() - r4;
+	const vector d = p - r4;
+	const double det = (a % b).dot(c);
+	bary[0] = (d % b).dot(c) / det;
+	bary[1] = (a % d).dot(c) / det;
+	bary[2] = (a % b).dot(d) / det;
+	bary[3] = 1 - bary[0] - bary[1] - bary[2];
+}
+
+index tet_locator::search(const vector &p, double *bary) const {
+	if (nodes.empty())
+		return BAD_INDEX;
+
+	/* Tree depth is bounded by Morton code bits plus middle splits of equal codes */
+	index stack[128];
+	int top = 0;
+	stack[top++] = 0;
+	while (top > 0) {
+		const index id = stack[--top];
+		const node &n = nodes[id];
+		if (!inside(n.lo, n.hi, p))
+			continue;
+		if (n.right != BAD_INDEX) {
+			stack[top++] = n.right;
+			stack[top++] = id + 1;
+			continue;
+		}
+		for (index k = n.first; k < n.last; k++) {
+			barycentric(m, order[k], p, bary);
+			if (*std::min_element(bary, bary + 4) >= -eps)
+				return order[k];
+		}
+	}
+	return BAD_INDEX;
+}
+
+index tet_locator::walk(const vector &p, index start, double *bary) const {
+	index t = start;
+	for (int step = 0; step < MAX_WALK; step++) {
+		barycentric(m, t, p, bary);
+		const int j = std::min_element(bary, bary + 4) - bary;
+		if (bary[j] >= -eps)
+			return t;
+		/* Face j is opposite to vertex j, cross it toward p */
+		const face &f = m.tets(t).f(j).flip();
+		if (f.is_border())
+			return BAD_INDEX;
+		t = f.tet().idx();
+	}
+	return BAD_INDEX;
+}
+
+index tet_locator::locate(const vector &p, double *bary) const {
+	double tmp[4];
+	return search(p, bary ? bary : tmp);
+}
+
+index tet_locator::locate_from(const vector &p, index guess, double *bary) const {
+	double tmp[4];
+	if (!bary)
+		bary = tmp;
+	if (guess != BAD_INDEX) {
+		index t = walk(p, guess, bary);
+		if (t != BAD_INDEX)
+			return t;
+	}
+	return search(p, bary);
+}
+
+void tet_locator::locate(index n, const vector *p, index *tets, double *bary, const index *guess) const {
+#ifdef USE_OPENMP
+#	pragma omp parallel for schedule(dynamic, 256) num_threads(mesh3d::num_threads())
+#endif
+	for (index i = 0; i < n; i++)
+		tets[i] = locate_from(p[i], guess ? guess[i] : BAD_INDEX, bary ? bary + 4 * i : 0);
+}
@@ -0,0 +1,73 @@
+#ifndef __MESH3D__TET_LOCATOR_H__
+#define __MESH3D__TET_LOCATOR_H__
+
+#include "common.h"
+#include "vector.h"
+
+#include <vector>
+#include <stdint.h>
+
+namespace mesh3d {
+
+class mesh;
+
+/** A class for finding tetrahedrons containing given points
+*
+* Uses a bounding volume hierarchy over tetrahedron bounding boxes. Tetrahedrons are ordered
+* along a Morton curve of their centers and the hierarchy is built by splitting Morton code
+* ranges. The locator keeps a reference to the mesh and becomes stale when vertices move,
+* call refit to update bounding boxes. */
+class tet_locator {
+	struct node {
+		double lo[3];
+		double hi[3];
+		index right; //!< right child index, left child follows the node. BAD_INDEX for leaves
+		index first; //!< first tet in order array, leaves only
+		index last; //!< past the last tet in order array, leaves only
+	};
+
+	const mesh &m;
+	double eps;
+	std::vector<node> nodes;
+	std::vector<index> order;
+
+	index build(const std::vector<uint64_t> &codes, index first, index last);
+	index search(const vector &p, double *bary) const;
+	index walk(const vector &p, index start, double *bary) const;
+
+	tet_locator(const tet_locator &);
+	tet_locator &operator=(const tet_locator &);
+public:
+	/** Build locator for mesh m. Points outside of a tetrahedron by no more than
+	* eps in barycentric coordinates are considered inside */
+	tet_locator(const mesh &m, double eps = 1e-10);
+
+	/** Recompute bounding boxes after vertices were moved. Hierarchy is not rebuilt,
+	* so queries become slower if vertices move far */
+	void refit();
+
+	/** Find tetrahedron containing point p
+	*
+	* Returns tetrahedron index or BAD_INDEX if p is outside of the mesh.
+	* If bary is not null, it receives four barycentric coordinates of p */
+	index locate(const vector &p, double *bary = 0) const;
+
+	/** Find tetrahedron containing point p starting from tetrahedron guess
+	*
+	* Walks through neighbour tetrahedrons toward p, which is fast if guess is close to p.
+	* Falls back to the hierarchy search if the walk leaves the mesh */
+	index locate_from(const vector &p, index guess, double *bary = 0) const;
+
+	/** Find tetrahedrons containing n points p[i] in parallel
+	*
+	* Results are stored to tets[i] and, if bary is not null, to bary[4 * i + j].
+	* If guess is not null, guess[i] is used as a starting tetrahedron, BAD_INDEX means no guess */
+	void locate(index n, const vector *p, index *tets, double *bary = 0, const index *guess = 0) const;
+
+	/** Compute barycentric coordinates of point p in tetrahedron t */
+	static void barycentric(const mesh &m, index t, const vector &p, double *bary);
+};
+
+}
+
+#endif
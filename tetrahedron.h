@@ -36,8 +36,11 @@ public:
 		return _center;
 	}
 
-	/** Construct tetrahedron from four vertices */
-	tetrahedron(vertex &p1, vertex &p2, vertex &p3, vertex &p4) {
+	/** Construct tetrahedron from four vertices
+	*
+	* If geometry is false, center and volume of the tetrahedron and its faces
+	* are left zero until update_geometry is called */
+	tetrahedron(vertex &p1, vertex &p2, vertex &p3, vertex &p4, bool geometry = true) {
 		_p[0] = &p1;
 		_p[1] = &p2;
 		_p[2] = &p3;
@@ -46,18 +49,31 @@ public:
 		for (int j = 0; j < 4; j++)
 			_p[j]->add(this, j);
 
-		_f[0] = new face(p2, p3, p4, this, 0);
-		_f[1] = new face(p1, p4, p3, this, 1);
-		_f[2] = new face(p1, p2, p4, this, 2);
-		_f[3] = new face(p1, p3, p2, this, 3);
+		_f[0] = new face(p2, p3, p4, this, 0, geometry);
+		_f[1] = new face(p1, p4, p3, this, 1, geometry);
+		_f[2] = new face(p1, p2, p4, this, 2, geometry);
+		_f[3] = new face(p1, p3, p2, this, 3, geometry);
 
-		_center += p1.r();
-		_center += p2.r();
-		_center += p3.r();
-		_center += p4.r();
+		_volume = 0;
+
+		if (geometry)
+			update_geometry();
+	}
+
+	/** Compute center and volume from vertex positions. Faces are not updated */
+	void update_geometry() {
+		const vector &r1 = _p[0]->r();
+		const vector &r2 = _p[1]->r();
+		const vector &r3 = _p[2]->r();
+		const vector &r4 = _p[3]->r();
+
+		_center = r1;
+		_center += r2;
+		_center += r3;
+		_center += r4;
 		_center *= 0.25;
 
-		_volume = 1. / 6 * (p3.r() - p4.r()).dot((p1.r() - p4.r()) % (p2.r() - p4.r()));
+		_volume = 1. / 6 * (r3 - r4).dot((r1 - r4) % (r2 - r4));
 	}
 
 	/** Destroy tetrahedron object */
@@ -0,0 +1,38 @@
+#include "vol2m3d.h"
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+
+using namespace mesh3d;
+
+void usage(const char *prog) {
+	std::cerr << "Usage: " << prog << " [-m memory_MiB] [-t temp_dir] input.vol output.m3d" << std::endl;
+}
+
+int main(int argc, char **argv) {
+	size_t memory = 256;
+	const char *temp_dir = 0;
+	int i = 1;
+	while (i < argc && (0 == strcmp(argv[i], "-m") || 0 == strcmp(argv[i], "-t"))) {
+		if (i + 1 >= argc) {
+			usage(argv[0]);
+			return 1;
+		}
+		if (0 == strcmp(argv[i], "-m"))
+			memory = strtoul(argv[i + 1], 0, 10);
+		else
+			temp_dir = argv[i + 1];
+		i += 2;
+	}
+	if (argc - i != 2 || memory == 0) {
+		usage(argv[0]);
+		return 1;
+	}
+	try {
+		vol_to_m3d(argv[i], argv[i + 1], memory << 20, temp_dir);
+	} catch (std::exception &e) {
+		std::cerr << "Conversion failed: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
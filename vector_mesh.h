@@ -0,0 +1,57 @@
+#ifndef __MESH3D__VECTOR_MESH_H__
+#define __MESH3D__VECTOR_MESH_H__
+
+#include "simple_mesh.h"
+#include <vector>
+
+namespace mesh3d {
+
+/** simple_mesh implementation stored in plain arrays, used to build meshes in memory */
+class vector_mesh : public simple_mesh {
+public:
+	std::vector<double> vert; //!< vertex coordinates, 3 per vertex
+	std::vector<index> tet; //!< tetrahedron vertices, 4 per tetrahedron
+	std::vector<index> bnd; //!< boundary face vertices, 3 per face
+	std::vector<index> tetmat; //!< tetrahedron materials
+	std::vector<index> bndmat; //!< boundary face materials
+
+	/** Construct empty mesh */
+	vector_mesh() { }
+	/** Copy mesh from another simple_mesh */
+	explicit vector_mesh(const simple_mesh &sm) {
+		const index nV = sm.num_vertices();
+		const index nT = sm.num_tetrahedrons();
+		const index nB = sm.num_bnd_faces();
+		for (index i = 0; i < nV; i++)
+			vert.insert(vert.end(), sm.vertex_coord(i), sm.vertex_coord(i) + 3);
+		for (index i = 0; i < nT; i++) {
+			tet.insert(tet.end(), sm.tet_verts(i), sm.tet_verts(i) + 4);
+			tetmat.push_back(sm.tet_material(i));
+		}
+		for (index i = 0; i < nB; i++) {
+			bnd.insert(bnd.end(), sm.bnd_verts(i), sm.bnd_verts(i) + 3);
+			bndmat.push_back(sm.bnd_material(i));
+		}
+	}
+
+	/** Return number of vertices in mesh */
+	virtual index num_vertices() const { return vert.size() / 3; }
+	/** Return number of tetrahedrons in mesh */
+	virtual index num_tetrahedrons() const { return tet.size() / 4; }
+	/** Return number of boundary faces in mesh */
+	virtual index num_bnd_faces() const { return bnd.size() / 3; }
+	/** Return i-th vertex coordinates as an array of 3 doubles */
+	virtual const double *vertex_coord(index i) const { return &vert[3 * i]; }
+	/** Return i-th tetrahedron vertices as an array of 4 indices. Order matters */
+	virtual const index *tet_verts(index i) const { return &tet[4 * i]; }
+	/** Return i-th boundary face vertices as an array of 3 indices. Order matters */
+	virtual const index *bnd_verts(index i) const { return &bnd[3 * i]; }
+	/** Return i-th tetrahedron material (color) */
+	virtual index tet_material(index i) const { return tetmat[i]; }
+	/** Return i-th boundary face material (color) */
+	virtual index bnd_material(index i) const { return bndmat[i]; }
+};
+
+}
+
+#endif
@@ -4,7 +4,6 @@
 #include "vector.h"
 #include "element.h"
 #include <vector>
-#include <map>
 #include <algorithm>
 
 namespace mesh3d {
@@ -48,7 +47,6 @@ class vertex : public element {
 
 	std::vector<tet_vertex> _tetrahedrons;
 	std::vector<face_vertex> _faces;
-	std::map<index, index> _aliases;
 
 	vertex(const vertex &p);
 	vertex &operator =(const vertex &p);
@@ -59,6 +57,9 @@ public:
 	/** Get vertex position */
 	const vector &r() const { return _r; }
 
+	/** Set vertex position. Geometry of adjacent faces and tetrahedrons is not updated */
+	void set_r(const vector &r) { _r = r; }
+
 	/** Get a list of tetrahedrons that contain this vertex */
 	const std::vector<tet_vertex> &tetrahedrons() const {
 		return _tetrahedrons;
@@ -69,11 +70,6 @@ public:
 		return _faces;
 	}
 
-	/** Get a map of foreign aliases for this vertex domain -> index in domain */
-	const std::map<index, index> &aliases() const {
-		return _aliases;
-	}
-
 	/** Add a tetrahedron to vertex tetrahedrons list */
 	void add(const tetrahedron *t, int li) {
 		_tetrahedrons.push_back(tet_vertex(t, li));
@@ -84,11 +80,6 @@ public:
 		_faces.push_back(face_vertex(f, li));
 	}
 
-	/** Add an alias from another domain */
-	void add(index domain_id, index remote_idx) {
-		_aliases[domain_id] = remote_idx;
-	}
-
 	/** Sort tetrahedrons and faces lists */
 	void sort_lists() {
 		std::sort(_tetrahedrons.begin(), _tetrahedrons.end(), tet_vertex::less);
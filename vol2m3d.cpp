@@ -0,0 +1,404 @@
+#include "vol2m3d.h"
+#include "vol_mesh.h"
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+#include <queue>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <stdint.h>
+#include <unistd.h>
+
+using namespace mesh3d;
+
+namespace mesh3d {
+
+namespace {
+
+const uint64_t MESH3D_SIGNATURE = 0x004853454d544554ull;
+const uint64_t MESH3D_SIGNATURE_V1 = 0x014853454d544554ull;
+/** Marks boundary face ids until tetrahedron count is known */
+const uint64_t BND_FLAG = 1ull << 63;
+/** Maximum number of runs merged at once */
+const size_t MAX_FANIN = 64;
+
+/** Anonymous temporary file in directory dir, removed on close */
+class temp_file {
+	FILE *f;
+	temp_file(const temp_file &);
+	temp_file &operator=(const temp_file &);
+public:
+	temp_file(const std::string &dir) : f(0) {
+		std::string name = dir + "/vol2m3d-XXXXXX";
+		std::vector<char> templ(name.begin(), name.end());
+		templ.push_back(0);
+		int fd = mkstemp(&templ[0]);
+		if (fd < 0)
+			throw std::runtime_error("Could not create temporary file in `" + dir + "'");
+		unlink(&templ[0]);
+		f = fdopen(fd, "w+b");
+		if (!f) {
+			close(fd);
+			throw std::runtime_error("Could not create temporary file in `" + dir + "'");
+		}
+	}
+	~temp_file() { fclose(f); }
+	void write(const void *p, size_t bytes) {
+		if (bytes && fwrite(p, 1, bytes, f) != bytes)
+			throw std::runtime_error("Could not write temporary file");
+	}
+	size_t read(void *p, size_t bytes) {
+		return fread(p, 1, bytes, f);
+	}
+	void rewind() {
+		fflush(f);
+		fseek(f, 0, SEEK_SET);
+	}
+	/** Append whole contents to file o */
+	void copy_to(FILE *o) {
+		rewind();
+		char buf[1 << 16];
+		size_t n;
+		while ((n = read(buf, sizeof(buf))) > 0)
+			if (fwrite(buf, 1, n, o) != n)
+				throw std::runtime_error("Could not write output file");
+	}
+};
+
+/** Buffered sequential reader of records from a temporary file */
+template <class R>
+class run_reader {
+	temp_file *f;
+	std::vector<R> buf;
+	size_t pos, len;
+public:
+	run_reader(temp_file *f, size_t records) : f(f), buf(std::max<size_t>(records, 1)), pos(0), len(0) {
+		f->rewind();
+	}
+	bool next(R &r) {
+		if (pos == len) {
+			len = f->read(&buf[0], buf.size() * sizeof(R)) / sizeof(R);
+			pos = 0;
+			if (len == 0)
+				return false;
+		}
+		r = buf[pos++];
+		return true;
+	}
+};
+
+/** External merge sort of fixed size records using at most memory_limit bytes for buffers */
+template <class R, class Less>
+class external_sorter {
+	size_t capacity;
+	std::string dir;
+	std::vector<R> buf;
+	std::vector<temp_file *> runs;
+
+	std::vector<run_reader<R> *> readers;
+	struct head {
+		R r;
+		size_t run;
+	};
+	struct head_greater {
+		bool operator()(const head &a, const head &b) const { return Less()(b.r, a.r); }
+	};
+	std::priority_queue<head, std::vector<head>, head_greater> heap;
+
+	external_sorter(const external_sorter &);
+	external_sorter &operator=(const external_sorter &);
+
+	void flush() {
+		if (buf.empty())
+			return;
+		std::sort(buf.begin(), buf.end(), Less());
+		temp_file *t = new temp_file(dir);
+		runs.push_back(t);
+		t->write(&buf[0], buf.size() * sizeof(R));
+		buf.clear();
+	}
+
+	void open_readers(size_t first, size_t last) {
+		size_t per_run = capacity / (last - first + 1);
+		for (size_t i = first; i < last; i++) {
+			readers.push_back(new run_reader<R>(runs[i], per_run));
+			head h;
+			if (readers.back()->next(h.r)) {
+				h.run = readers.size() - 1;
+				heap.push(h);
+			}
+		}
+	}
+
+	void close_readers() {
+		for (size_t i = 0; i < readers.size(); i++)
+			delete readers[i];
+		readers.clear();
+	}
+public:
+	external_sorter(size_t memory_limit, const std::string &dir)
+		: capacity(std::max<size_t>(memory_limit / sizeof(R), 2)), dir(dir) { }
+	~external_sorter() {
+		close_readers();
+		for (size_t i = 0; i < runs.size(); i++)
+			delete runs[i];
+	}
+
+	/** Add a record */
+	void push(const R &r) {
+		buf.push_back(r);
+		if (buf.size() >= capacity)
+			flush();
+	}
+
+	/** Finish input, records could be retrieved with next() */
+	void finish() {
+		flush();
+		std::vector<R>().swap(buf);
+		/* Reduce number of runs so every run gets a reasonable buffer */
+		while (runs.size() > MAX_FANIN) {
+			std::vector<temp_file *> merged;
+			for (size_t first = 0; first < runs.size(); first += MAX_FANIN) {
+				size_t last = std::min(first + MAX_FANIN, runs.size());
+				temp_file *t = new temp_file(dir);
+				open_readers(first, last);
+				R r;
+				while (next(r))
+					t->write(&r, sizeof(r));
+				close_readers();
+				for (size_t i = first; i < last; i++)
+					delete runs[i];
+				merged.push_back(t);
+			}
+			runs.swap(merged);
+		}
+		open_readers(0, runs.size());
+	}
+
+	/** Get next record in sorted order. Returns false when there are no more records */
+	bool next(R &r) {
+		if (heap.empty())
+			return false;
+		head h = heap.top();
+		heap.pop();
+		r = h.r;
+		if (readers[h.run]->next(h.r))
+			heap.push(h);
+		return true;
+	}
+};
+
+struct face_rec {
+	uint64_t v[3];
+	uint64_t id;
+	bool same_face(const face_rec &o) const {
+		return v[0] == o.v[0] && v[1] == o.v[1] && v[2] == o.v[2];
+	}
+};
+
+struct face_rec_less {
+	bool operator()(const face_rec &a, const face_rec &b) const {
+		if (a.v[0] != b.v[0])
+			return a.v[0] < b.v[0];
+		if (a.v[1] != b.v[1])
+			return a.v[1] < b.v[1];
+		if (a.v[2] != b.v[2])
+			return a.v[2] < b.v[2];
+		return a.id < b.id;
+	}
+};
+
+struct flip_rec {
+	uint64_t id;
+	uint64_t flip;
+};
+
+struct flip_rec_less {
+	bool operator()(const flip_rec &a, const flip_rec &b) const {
+		return a.id < b.id;
+	}
+};
+
+/** Local vertex indices of tetrahedron faces, in the same order as tetrahedron class uses */
+const int tet_face_verts[4][3] = {{1, 2, 3}, {0, 3, 2}, {0, 1, 3}, {0, 2, 1}};
+
+face_rec make_face(uint64_t a, uint64_t b, uint64_t c, uint64_t id) {
+	face_rec f;
+	f.v[0] = a;
+	f.v[1] = b;
+	f.v[2] = c;
+	std::sort(f.v, f.v + 3);
+	f.id = id;
+	return f;
+}
+
+/** Convert material to stored color type */
+color_type to_color(index mat) {
+	if (mat == BAD_INDEX)
+		return BAD_COLOR;
+	if (mat >= BAD_COLOR)
+		throw std::domain_error("Material does not fit into color type");
+	return static_cast<color_type>(mat);
+}
+
+/** vol_reader streaming sections to temporary files */
+class stream_reader : public vol_reader {
+public:
+	temp_file pts, tets, tetmat, bnds, bndmat;
+	uint64_t nV, nT, nB;
+	external_sorter<face_rec, face_rec_less> &faces;
+
+	stream_reader(external_sorter<face_rec, face_rec_less> &faces, const std::string &dir)
+		: pts(dir), tets(dir), tetmat(dir), bnds(dir), bndmat(dir), nV(0), nT(0), nB(0), faces(faces) { }
+
+	virtual void begin_points(index n) {
+		nV = n;
+	}
+	virtual void point(index, const double *r) {
+		pts.write(r, 3 * sizeof(double));
+	}
+	virtual void begin_tets(index n) {
+		nT = n;
+	}
+	virtual void tet(index i, index mat, const index *v) {
+		index w[4];
+		color_type col = to_color(mat);
+		for (int j = 0; j < 4; j++)
+			w[j] = v[j];
+		tets.write(w, sizeof(w));
+		tetmat.write(&col, sizeof(col));
+		for (int j = 0; j < 4; j++)
+			faces.push(make_face(w[tet_face_verts[j][0]], w[tet_face_verts[j][1]], w[tet_face_verts[j][2]], 4 * i + j));
+	}
+	virtual void begin_bnd_faces(index) {
+	}
+	virtual void bnd_face(index i, index mat, const index *v) {
+		index w[3];
+		color_type col = to_color(mat);
+		for (int j = 0; j < 3; j++)
+			w[j] = v[j];
+		bnds.write(w, sizeof(w));
+		bndmat.write(&col, sizeof(col));
+		faces.push(make_face(w[0], w[1], w[2], BND_FLAG | i));
+	}
+	virtual void end_bnd_faces(index n) {
+		nB = n;
+	}
+};
+
+/** Write count copies of value */
+template <class T>
+void write_fill(FILE *o, T value, uint64_t count) {
+	std::vector<T> buf(std::min<uint64_t>(count, 1 << 13), value);
+	while (count > 0) {
+		size_t n = std::min<uint64_t>(count, buf.size());
+		if (fwrite(&buf[0], sizeof(T), n, o) != n)
+			throw std::runtime_error("Could not write output file");
+		count -= n;
+	}
+}
+
+/** Face id in the mesh from the id in a face record */
+uint64_t face_id(uint64_t id, uint64_t nT) {
+	return (id & BND_FLAG) ? 4 * nT + (id & ~BND_FLAG) : id;
+}
+
+/** Output file, closed on destruction */
+struct output_file {
+	FILE *f;
+	output_file(const char *fn) : f(fopen(fn, "wb")) {
+		if (!f)
+			throw std::invalid_argument("Could not open file `" + std::string(fn) + "'");
+	}
+	void close() {
+		FILE *t = f;
+		f = 0;
+		if (fclose(t) != 0)
+			throw std::runtime_error("Could not write output file");
+	}
+	~output_file() {
+		if (f)
+			fclose(f);
+	}
+};
+
+template <class T>
+void write_value(FILE *o, T v) {
+	if (fwrite(&v, sizeof(v), 1, o) != 1)
+		throw std::runtime_error("Could not write output file");
+}
+
+void write_u64(FILE *o, uint64_t v) {
+	write_value(o, v);
+}
+
+}
+
+}
+
+void mesh3d::vol_to_m3d(const char *vol_fn, const char *m3d_fn, size_t memory_limit, const char *temp_dir) {
+	std::string dir = temp_dir ? temp_dir : "";
+	if (dir.empty()) {
+		const char *env = getenv("TMPDIR");
+		dir = env && *env ? env : "/tmp";
+	}
+	/* Two sorters are alive at once, when the first one is merged into the second one */
+	external_sorter<face_rec, face_rec_less> faces(memory_limit / 2, dir);
+	stream_reader r(faces, dir);
+	parse_vol(vol_fn, r);
+	faces.finish();
+
+	const uint64_t nT = r.nT;
+	const uint64_t nF = 4 * nT + r.nB;
+	if (r.nV >= BAD_INDEX || nF >= BAD_INDEX)
+		throw std::domain_error("Mesh is too large for index type");
+
+	external_sorter<flip_rec, flip_rec_less> flips(memory_limit / 2, dir);
+	face_rec a, b;
+	bool first = true;
+	while (faces.next(a)) {
+		if (!first && a.same_face(b))
+			throw std::logic_error("Face is shared by more than two elements");
+		if (!faces.next(b) || !a.same_face(b))
+			throw std::logic_error("Face has no matching flipped face");
+		first = false;
+		flip_rec f;
+		f.id = face_id(a.id, nT);
+		f.flip = face_id(b.id, nT);
+		flips.push(f);
+		std::swap(f.id, f.flip);
+		flips.push(f);
+	}
+	flips.finish();
+
+	output_file o(m3d_fn);
+	/* Same layout as mesh::serialize, narrow builds write TETMESH\1 with field widths */
+	if (sizeof(index) == 8 && sizeof(color_type) == 8) {
+		write_u64(o.f, MESH3D_SIGNATURE);
+	} else {
+		write_u64(o.f, MESH3D_SIGNATURE_V1);
+		write_u64(o.f, sizeof(index));
+		write_u64(o.f, sizeof(color_type));
+	}
+	write_u64(o.f, 0);
+	write_u64(o.f, 1);
+	write_u64(o.f, r.nV);
+	write_u64(o.f, r.nT);
+	write_u64(o.f, r.nB);
+	write_u64(o.f, 0);
+	r.pts.copy_to(o.f);
+	r.tets.copy_to(o.f);
+	r.bnds.copy_to(o.f);
+	write_fill(o.f, BAD_COLOR, r.nV);
+	r.tetmat.copy_to(o.f);
+	write_fill(o.f, BAD_COLOR, 4 * nT);
+	r.bndmat.copy_to(o.f);
+	flip_rec f;
+	for (uint64_t i = 0; i < nF; i++) {
+		if (!flips.next(f) || f.id != i)
+			throw std::logic_error("Face has no matching flipped face");
+		write_value(o.f, static_cast<index>(f.flip));
+	}
+	o.close();
+}
@@ -0,0 +1,20 @@
+#ifndef __MESH3D__VOL2M3D_H__
+#define __MESH3D__VOL2M3D_H__
+
+#include "common.h"
+
+namespace mesh3d {
+
+/** Convert vol file to binary mesh file without building mesh object
+*
+* Produces the same file as mesh::serialize for a mesh constructed from vol_mesh.
+* Face flips are matched with an external sort of face keys, so memory usage is
+* bounded by memory_limit bytes plus a few buffers, whatever the mesh size.
+* Intermediate data and sorted runs are kept in anonymous temporary files in temp_dir,
+* or in TMPDIR (/tmp if unset) when temp_dir is null or empty. Choose a disk backed
+* directory there, runs in a memory backed one defeat the memory bound. */
+void vol_to_m3d(const char *vol_fn, const char *m3d_fn, size_t memory_limit = 256 << 20, const char *temp_dir = 0);
+
+}
+
+#endif
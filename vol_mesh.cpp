@@ -1,4 +1,5 @@
 #include "vol_mesh.h"
+#include "instrument.h"
 #include <stdexcept>
 #include <fstream>
 #include <cstring>
@@ -62,22 +63,22 @@ long long get_ll(char *&p) {
 	return ret;
 }
 
-vol_mesh::vol_mesh(const char *fn) {
+void mesh3d::parse_vol(const char *fn, vol_reader &r) {
+	MESH3D_TIMED_SCOPE("parse_vol");
 	std::ifstream f(fn, std::ios::in);
 
 	if (!f)
 		throw std::invalid_argument("Could not read file `" + std::string(fn) +"'");
 	
 	char buf[1024];
-	nV = 0;
-	nB = 0;
-	nT = 0;
 	int iext = 0;
 	int i = 0, cnt = 0;
+	uint64_t lines = 0;
 
 	State state = ST_NORM;
 
 	while (!!f.getline(buf, 1024)) {
+		lines++;
 		if (buf[0] == '#')
 			continue;
 		if (state == ST_NORM) {
@@ -103,27 +104,27 @@ vol_mesh::vol_mesh(const char *fn) {
 			}
 		}
 		if (state == ST_PTS_INIT) {
-			nV = cnt = atoi(buf);
-			vert.resize(3 * nV);
+			cnt = atoi(buf);
+			r.begin_points(cnt);
 			i = 0;
 			state = cnt ? ST_PTS_DATA : ST_NORM;
 			continue;
 		}
 		if (state == ST_VOL_INIT) {
-			nT = cnt = atoi(buf);
-			tet.resize(4 * nT);
-			tetmat.resize(nT);
+			cnt = atoi(buf);
+			r.begin_tets(cnt);
 			i = 0;
 			state = cnt ? ST_VOL_DATA : ST_NORM;
 			continue;
 		}
 		if (state == ST_SURF_INIT) {
-			nB = cnt = atoi(buf);
-			bnd.resize(3 * nB);
-			bndmat.resize(nB);
+			cnt = atoi(buf);
+			r.begin_bnd_faces(cnt);
 			iext = 0;
 			i = 0;
 			state = cnt ? ST_SURF_DATA : ST_NORM;
+			if (!cnt)
+				r.end_bnd_faces(0);
 			continue;
 		}
 		if (state == ST_CURVE_INIT) {
@@ -136,9 +137,11 @@ vol_mesh::vol_mesh(const char *fn) {
 		if (state == ST_PTS_DATA) {
 			// sscanf(buf, "%lf %lf %lf", &vert[3*i], &vert[3*i + 1], &vert[3*i + 2]);
 			char *p = buf;
-			vert[3*i + 0] = get_double(p);
-			vert[3*i + 1] = get_double(p);
-			vert[3*i + 2] = get_double(p);
+			double x[3];
+			x[0] = get_double(p);
+			x[1] = get_double(p);
+			x[2] = get_double(p);
+			r.point(i, x);
 			if (++i == cnt)
 				state = ST_NORM;
 			continue;
@@ -148,14 +151,16 @@ vol_mesh::vol_mesh(const char *fn) {
 			// sscanf(buf, "%lld %d %lld %lld %lld %lld", &tetmat[i], &np, 
 			// 		&tet[4*i], &tet[4*i + 1], &tet[4*i + 2], &tet[4*i + 3]);
 			char *p = buf;
-			tetmat[i] = get_ll(p);
+			index mat = get_ll(p);
+			index v[4];
 			np = get_int(p);
-			tet[4*i + 0] = get_ll(p) - 1;
-			tet[4*i + 1] = get_ll(p) - 1;
-			tet[4*i + 2] = get_ll(p) - 1;
-			tet[4*i + 3] = get_ll(p) - 1;
+			v[0] = get_ll(p) - 1;
+			v[1] = get_ll(p) - 1;
+			v[2] = get_ll(p) - 1;
+			v[3] = get_ll(p) - 1;
 			if (np != 4)
 				throw std::domain_error("High-order tetrahedrons not implemented");
+			r.tet(i, mat, v);
 			if (++i == cnt)
 				state = ST_NORM;
 			continue;
@@ -166,20 +171,21 @@ vol_mesh::vol_mesh(const char *fn) {
 			//		&bnd[3*iext], &bnd[3*iext + 1], &bnd[3*iext + 2]);
 			char *p = buf;
 			get_int(p);
-			bndmat[iext] = get_ll(p);
+			index mat = get_ll(p);
+			index v[3];
 			get_int(p);
 			domout = get_int(p);
 			np = get_int(p);
-			bnd[3*iext + 0] = get_ll(p) - 1;
-			bnd[3*iext + 1] = get_ll(p) - 1;
-			bnd[3*iext + 2] = get_ll(p) - 1;
-			if (domout == 0) 
-				iext++;
+			v[0] = get_ll(p) - 1;
+			v[1] = get_ll(p) - 1;
+			v[2] = get_ll(p) - 1;
 			if (np != 3)
 				throw std::domain_error("High-order faces not implemented");
+			if (domout == 0) 
+				r.bnd_face(iext++, mat, v);
 			if (++i == cnt) {
 				state = ST_NORM;
-				nB = iext;
+				r.end_bnd_faces(iext);
 			}
 			continue;
 		}
@@ -190,11 +196,62 @@ vol_mesh::vol_mesh(const char *fn) {
 		}
 	}
 	f.close();
+	MESH3D_COUNT("parse_vol.lines", lines);
 	if (state != ST_STOP)
 		throw std::logic_error("Parse vol file failed: state = `" + 
 			getStateString(state) + "' at the end of file");
 }
 
+namespace mesh3d {
+
+/** vol_reader filling vol_mesh arrays */
+class vol_mesh_reader : public vol_reader {
+	vol_mesh &vm;
+public:
+	vol_mesh_reader(vol_mesh &vm) : vm(vm) { }
+	virtual void begin_points(index n) {
+		vm.nV = n;
+		vm.vert.resize(3 * n);
+	}
+	virtual void point(index i, const double *r) {
+		vm.vert[3*i + 0] = r[0];
+		vm.vert[3*i + 1] = r[1];
+		vm.vert[3*i + 2] = r[2];
+	}
+	virtual void begin_tets(index n) {
+		vm.nT = n;
+		vm.tet.resize(4 * n);
+		vm.tetmat.resize(n);
+	}
+	virtual void tet(index i, index mat, const index *v) {
+		vm.tetmat[i] = mat;
+		for (int j = 0; j < 4; j++)
+			vm.tet[4*i + j] = v[j];
+	}
+	virtual void begin_bnd_faces(index n) {
+		vm.bnd.resize(3 * n);
+		vm.bndmat.resize(n);
+	}
+	virtual void bnd_face(index i, index mat, const index *v) {
+		vm.bndmat[i] = mat;
+		for (int j = 0; j < 3; j++)
+			vm.bnd[3*i + j] = v[j];
+	}
+	virtual void end_bnd_faces(index n) {
+		vm.nB = n;
+	}
+};
+
+}
+
+vol_mesh::vol_mesh(const char *fn) {
+	nV = 0;
+	nB = 0;
+	nT = 0;
+	vol_mesh_reader r(*this);
+	parse_vol(fn, r);
+}
+
 vol_mesh::~vol_mesh() {
 }
 
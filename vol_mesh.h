@@ -6,6 +6,30 @@
 
 namespace mesh3d {
 
+/** Receiver of elements found by parse_vol, in the order of the file sections */
+class vol_reader {
+public:
+	/** Virtual destructor */
+	virtual ~vol_reader() { }
+	/** Points section of n points starts */
+	virtual void begin_points(index n) = 0;
+	/** i-th point with coordinates r */
+	virtual void point(index i, const double *r) = 0;
+	/** Volume elements section of n tetrahedrons starts */
+	virtual void begin_tets(index n) = 0;
+	/** i-th tetrahedron with material mat and vertices v (zero based) */
+	virtual void tet(index i, index mat, const index *v) = 0;
+	/** Surface elements section of at most n boundary faces starts */
+	virtual void begin_bnd_faces(index n) = 0;
+	/** i-th boundary face with material mat and vertices v (zero based) */
+	virtual void bnd_face(index i, index mat, const index *v) = 0;
+	/** Surface elements section ends with n boundary faces found */
+	virtual void end_bnd_faces(index n) = 0;
+};
+
+/** Parse vol file fn passing its contents to r. Only outer boundary faces are reported */
+void parse_vol(const char *fn, vol_reader &r);
+
 /** simple_mesh implementation for vol mesh format (NETGEN default output) */
 class vol_mesh : public simple_mesh {
 	int nV;
@@ -16,6 +40,8 @@ class vol_mesh : public simple_mesh {
 	std::vector<index> tet;
 	std::vector<index> bndmat;
 	std::vector<index> tetmat;
+
+	friend class vol_mesh_reader;
 public:
 	/** Constuct vol_mesh from file fn */
 	vol_mesh(const char *fn);
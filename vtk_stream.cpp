@@ -1,11 +1,12 @@
 #include "vtk_stream.h"
+#include <sstream>
 
 using namespace mesh3d;
 
 namespace mesh3d {
 
 template<>
-void vtk_stream::put<float>(float v) {
+void vtk_stream::put<float>(std::ostream &s, float v) {
 	union {
 		float w;
 		uint32_t i;
@@ -13,11 +14,11 @@ void vtk_stream::put<float>(float v) {
 	} x;
 	x.w = v;
 	x.i = __builtin_bswap32(x.i);
-	o.write(&x.c[0], sizeof(x));
+	s.write(&x.c[0], sizeof(x));
 }
 
 template<>
-void vtk_stream::put<double>(double v) {
+void vtk_stream::put<double>(std::ostream &s, double v) {
 	union {
 		double w;
 		uint64_t i;
@@ -25,47 +26,47 @@ void vtk_stream::put<double>(double v) {
 	} x;
 	x.w = v;
 	x.i = __builtin_bswap64(x.i);
-	o.write(&x.c[0], sizeof(x));
+	s.write(&x.c[0], sizeof(x));
 }
 
 template<>
-void vtk_stream::put<uint32_t>(uint32_t v) {
+void vtk_stream::put<uint32_t>(std::ostream &s, uint32_t v) {
 	union {
 		uint32_t i;
 		char c[4];
 	} x;
 	x.i = __builtin_bswap32(v);
-	o.write(&x.c[0], sizeof(x));
+	s.write(&x.c[0], sizeof(x));
 }
 
 template<>
-void vtk_stream::put<int32_t>(int32_t v) {
+void vtk_stream::put<int32_t>(std::ostream &s, int32_t v) {
 	union {
 		int32_t i;
 		char c[4];
 	} x;
 	x.i = __builtin_bswap32(v);
-	o.write(&x.c[0], sizeof(x));
+	s.write(&x.c[0], sizeof(x));
 }
 
 template<>
-void vtk_stream::put<uint64_t>(uint64_t v) {
+void vtk_stream::put<uint64_t>(std::ostream &s, uint64_t v) {
 	union {
 		uint64_t i;
 		char c[8];
 	} x;
 	x.i = __builtin_bswap64(v);
-	o.write(&x.c[0], sizeof(x));
+	s.write(&x.c[0], sizeof(x));
 }
 
 template<>
-void vtk_stream::put<int64_t>(int64_t v) {
+void vtk_stream::put<int64_t>(std::ostream &s, int64_t v) {
 	union {
 		int64_t i;
 		char c[8];
 	} x;
 	x.i = __builtin_bswap64(v);
-	o.write(&x.c[0], sizeof(x));
+	s.write(&x.c[0], sizeof(x));
 }
 
 template<>
@@ -90,7 +91,27 @@ vtk_stream::vtk_stream(const char *fn) : o(fn, std::ios::out | std::ios::binary)
 	point_data_written = false;
 }
 
+void vtk_stream::write_fields(std::ostream &s, const field_registry &fields, field_location loc, bool cells) {
+	for (index k = 0; k < fields.size(); k++) {
+		const field &f = fields[k];
+		if (f.location() != loc)
+			continue;
+		switch (f.type()) {
+			case FIELD_INT32: write_field<int32_t>(s, f, cells); break;
+			case FIELD_FLOAT: write_field<float>(s, f, cells); break;
+			case FIELD_DOUBLE: write_field<double>(s, f, cells); break;
+		}
+	}
+}
+
+void vtk_stream::gather_vertex_fields(const field_registry &fields) {
+	std::ostringstream s;
+	write_fields(s, fields, VERTEX_FIELD, false);
+	vertex_fields = s.str();
+}
+
 void vtk_stream::write_header(const mesh &m, const std::string &comment) {
+	MESH3D_TIMED_SCOPE("vtk_stream::write_header");
 	if (header_written)
 		throw std::logic_error("Header is already written");
 
@@ -126,5 +147,89 @@ void vtk_stream::write_header(const mesh &m, const std::string &comment) {
 
 	header_written = true;
 	nV = verts.size();
-	nT = tets.size();
+	nC = tets.size();
+	point_map.clear();
+	cell_map.clear();
+
+	start_cell_data();
+	write_fields(o, m.fields(), TET_FIELD, true);
+	gather_vertex_fields(m.fields());
+}
+
+void vtk_stream::write_surface_header(const mesh &m, const std::string &comment) {
+	MESH3D_TIMED_SCOPE("vtk_stream::write_surface_header");
+	if (header_written)
+		throw std::logic_error("Header is already written");
+
+	const ptr_vector<face> &faces = m.faces();
+	const ptr_vector<vertex> &verts = m.vertices();
+
+	std::vector<index> local(verts.size(), BAD_INDEX);
+	point_map.clear();
+	cell_map.clear();
+	for (index i = 0; i < faces.size(); i++) {
+		const face &f = faces[i];
+		if (!f.is_border())
+			continue;
+		cell_map.push_back(i);
+		for (int j = 0; j < 3; j++) {
+			index vi = f.p(j).idx();
+			if (local[vi] == BAD_INDEX) {
+				local[vi] = point_map.size();
+				point_map.push_back(vi);
+			}
+		}
+	}
+
+	o 	<< "# vtk DataFile Version 3.0\n"
+		<< comment << "\n"
+		<< "BINARY\n"
+		<< "DATASET UNSTRUCTURED_GRID\n"
+		<< "POINTS " << point_map.size() << " double" << std::endl;
+
+	for (index i = 0; i < point_map.size(); i++) {
+		const vertex &v = verts[point_map[i]];
+		put(v.r().x);
+		put(v.r().y);
+		put(v.r().z);
+	}
+
+	o << "\nCELLS " << cell_map.size() << " " << 4 * cell_map.size() << std::endl;
+	for (index i = 0; i < cell_map.size(); i++) {
+		const face &f = faces[cell_map[i]];
+		uint32_t num_vertex = 3;
+		put(num_vertex);
+		for (int j = 0; j < 3; j++) {
+			uint32_t vidx = local[f.p(j).idx()];
+			put(vidx);
+		}
+	}
+	o << "\nCELL_TYPES " << cell_map.size() << std::endl;
+	uint32_t triangle_cell_type = 5;
+	for (index i = 0; i < cell_map.size(); i++)
+		put(triangle_cell_type);
+
+	header_written = true;
+	nV = point_map.size();
+	nC = cell_map.size();
+
+	start_cell_data();
+	write_fields(o, m.fields(), FACE_FIELD, true);
+	gather_vertex_fields(m.fields());
+}
+
+void vtk_stream::start_cell_data() {
+	if (cell_data_written)
+		return;
+	cell_data_written = true;
+	o << "\nCELL_DATA " << nC;
+}
+
+void vtk_stream::start_point_data() {
+	if (point_data_written)
+		return;
+	point_data_written = true;
+	o << "\nPOINT_DATA " << nV;
+	o.write(vertex_fields.data(), vertex_fields.size());
+	vertex_fields.clear();
 }
@@ -4,30 +4,63 @@
 #include <fstream>
 #include "common.h"
 #include "mesh.h"
+#include "instrument.h"
 #include <stdexcept>
 #include <stdint.h>
+#include <vector>
 
 namespace mesh3d {
 
-/** A class for exporting mesh and accompanying data to vtk file */
+/** A class for exporting mesh and accompanying data to vtk file
+*
+* Either the volume (tetrahedral cells) or the surface (border faces as triangle cells)
+* of a mesh may be written. In surface mode cell data arrays are indexed by mesh face index
+* and point data arrays by mesh vertex index, only the values of exported elements are written.
+*
+* Mesh fields are written automatically: tetrahedron fields (face fields in surface mode)
+* right after the header, vertex fields as the first point data arrays. Vertex field values
+* are gathered when the header is written, so the mesh is not referenced afterwards */
 class vtk_stream {
 	std::ofstream o;
 	bool header_written;
 	bool cell_data_written;
 	bool point_data_written;
-	index nV, nT;
+	index nV, nC;
+	std::vector<index> point_map;
+	std::vector<index> cell_map;
+	std::string vertex_fields;
 
 	template <class T>
-	void put(T v);
+	void write_field(std::ostream &s, const field &f, bool cells);
+	void write_fields(std::ostream &s, const field_registry &fields, field_location loc, bool cells);
+	void gather_vertex_fields(const field_registry &fields);
+
+	template <class T>
+	static void put(std::ostream &s, T v);
+	template <class T>
+	void put(T v) { put(o, v); }
 
 	template <class T>
 	const std::string name() const;
 
+	void start_cell_data();
+	void start_point_data();
+	index cell_id(index i) const { return cell_map.empty() ? i : cell_map[i]; }
+	index point_id(index i) const { return point_map.empty() ? i : point_map[i]; }
 public:
 	/** Construct vtk stream for specified file */
 	vtk_stream(const char *fn);
-	/** Write vtk header */
+	/** Write vtk header with mesh tetrahedrons as cells */
 	void write_header(const mesh &m, const std::string &comment = "comment");
+	/** Write vtk header with mesh border faces as triangle cells
+	*
+	* Only vertices referenced by border faces are written */
+	void write_surface_header(const mesh &m, const std::string &comment = "comment");
+
+	/** Return mesh face indices of the written cells in surface mode */
+	const std::vector<index> &surface_faces() const { return cell_map; }
+	/** Return mesh vertex indices of the written points in surface mode */
+	const std::vector<index> &surface_vertices() const { return point_map; }
 
 	/** Append scalar cell data to vtk file */
 	template <class T>
@@ -47,13 +80,12 @@ public:
 	
 	/** Finalize vtk file */
 	void close() {
-		if (!cell_data_written) {
-			cell_data_written = true;
-			o << "\nCELL_DATA " << nT;
-		}
-		if (!point_data_written) {
-			point_data_written = true;
-			o << "\nPOINT_DATA " << nV;
+		if (!o.is_open())
+			return;
+		MESH3D_TIMED_SCOPE("vtk_stream::close");
+		if (header_written) {
+			start_cell_data();
+			start_point_data();
 		}
 		o.close();
 	}
@@ -64,75 +96,79 @@ public:
 	}
 };
 
+template <class T>
+void vtk_stream::write_field(std::ostream &s, const field &f, bool cells) {
+	const index n = cells ? nC : nV;
+	if (f.components() == 3) {
+		s << "\nVECTORS " << f.name() << " " << name<T>() << std::endl;
+	} else {
+		s	<< "\nSCALARS " << f.name() << " " << name<T>() << " " << f.components()
+			<< "\nLOOKUP_TABLE default" << std::endl;
+	}
+	for (index i = 0; i < n; i++) {
+		const index k = cells ? cell_id(i) : point_id(i);
+		for (int c = 0; c < f.components(); c++)
+			put(s, f.data<T>(c)[k]);
+	}
+}
+
 template <class T>
 void vtk_stream::append_cell_data(const T *v, const std::string &id) {
+	MESH3D_TIMED_SCOPE("vtk_stream::append_cell_data");
 	if (!header_written)
 		throw std::logic_error("Write header first");
 	if (point_data_written)
 		throw std::logic_error("All cell data should be written prior to point data");
-	if (!cell_data_written) {
-		cell_data_written = true;
-		o << "\nCELL_DATA " << nT;
-	}
+	start_cell_data();
 	o	<< "\nSCALARS " << id << " " << name<T>()
 		<< "\nLOOKUP_TABLE default" << std::endl;
-	for (index i = 0; i < nT; i++)
-		put(v[i]);
+	for (index i = 0; i < nC; i++)
+		put(v[cell_id(i)]);
 }
 
 template <class T>
 void vtk_stream::append_cell_data(const vec<T> *v, const std::string &id) {
+	MESH3D_TIMED_SCOPE("vtk_stream::append_cell_data");
 	if (!header_written)
 		throw std::logic_error("Write header first");
 	if (point_data_written)
 		throw std::logic_error("All cell data should be written prior to point data");
-	if (!cell_data_written) {
-		cell_data_written = true;
-		o << "\nCELL_DATA " << nT;
-	}
+	start_cell_data();
 	o	<< "\nVECTORS " << id << " " << name<T>() << std::endl;
-	for (index i = 0; i < nT; i++) {
-		put(v[i].x);
-		put(v[i].y);
-		put(v[i].z);
+	for (index i = 0; i < nC; i++) {
+		const vec<T> &w = v[cell_id(i)];
+		put(w.x);
+		put(w.y);
+		put(w.z);
 	}
 }
 
 template <class T>
 void vtk_stream::append_point_data(const T *v, const std::string &id) {
+	MESH3D_TIMED_SCOPE("vtk_stream::append_point_data");
 	if (!header_written)
 		throw std::logic_error("Write header first");
-	if (!cell_data_written) {
-		cell_data_written = true;
-		o << "\nCELL_DATA " << nT;
-	}
-	if (!point_data_written) {
-		point_data_written = true;
-		o << "\nPOINT_DATA " << nV;
-	}
+	start_cell_data();
+	start_point_data();
 	o	<< "\nSCALARS " << id << " " << name<T>()
 		<< "\nLOOKUP_TABLE default" << std::endl;
 	for (index i = 0; i < nV; i++)
-		put(v[i]);
+		put(v[point_id(i)]);
 }
 
 template <class T>
 void vtk_stream::append_point_data(const vec<T> *v, const std::string &id) {
+	MESH3D_TIMED_SCOPE("vtk_stream::append_point_data");
 	if (!header_written)
 		throw std::logic_error("Write header first");
-	if (!cell_data_written) {
-		cell_data_written = true;
-		o << "\nCELL_DATA " << nT;
-	}
-	if (!point_data_written) {
-		point_data_written = true;
-		o << "\nPOINT_DATA " << nV;
-	}
+	start_cell_data();
+	start_point_data();
 	o	<< "\nVECTORS " << id << " " << name<T>() << std::endl;
 	for (index i = 0; i < nV; i++) {
-		put(v[i].x);
-		put(v[i].y);
-		put(v[i].z);
+		const vec<T> &w = v[point_id(i)];
+		put(w.x);
+		put(w.y);
+		put(w.z);
 	}
 }
 